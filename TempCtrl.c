@@ -10,13 +10,16 @@
 // Temperature Controller
 
 #include <inttypes.h>
+#include <string.h>
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <util/delay.h>
+#include <util/atomic.h>
 #include <compat/twi.h>
 #include <avr/eeprom.h>
 #include <avr/pgmspace.h>
+#include <avr/sleep.h>
 
 
 /*---------------------------Konstanten--------------------------------------*/
@@ -35,7 +38,8 @@
 #define TIMER0_STOP				TCCR0B &= ~TIMER0_PRESCALER
 
 // 8 MHz / 8 = 1 MHz; 1MHz / 65536 = 15.26 Hz
-#define TIMER1_PRESCALER		(_BV(CS10))
+// 1 Tick = 1 s, damit lassen sich die 1-Wire-Zeiten direkt in OCR1A eintragen
+#define TIMER1_PRESCALER		(_BV(CS11))
 
 #define TIMER1_START			TCCR1B |= TIMER1_PRESCALER
 #define TIMER1_STOP				TCCR1B &= ~TIMER1_PRESCALER
@@ -47,13 +51,49 @@
 #define TIMER2_START			TCCR2B |=  TIMER2_PRESCALER
 #define TIMER2_STOP				TCCR2B &= ~TIMER2_PRESCALER
 
+// Anzeige ber einen MAX7219 am SPI statt Multiplex an PortB/PortD,
+// Timer2 und die Multiplex-ISR entfallen, PortD und PB0/PB1/PB4/PB6/PB7 werden frei
+#define DSPL_MAX7219			0
+
+// Helligkeit: Timer2 Compare B schaltet die Stelle vor Ablauf ihres Zeitfensters ab,
+// beim MAX7219 ber dessen Intensity-Register (nur global)
+#define DSPL_DIM				1
+
+// Anzahl der Helligkeitsstufen, siehe dspl_dim_tab
+#define DSPL_DIM_NO				8
+
+// Fotowiderstand an ADC3 (gegen GND, Festwiderstand nach VCC),
+// Helligkeitsstufe 0 regelt dann automatisch nach
+#define DSPL_LDR				0
+
+// Anzeige nach so vielen Sekunden ohne Tastendruck abschalten (max. 255), 0 = nie;
+// der ADC wandelt dann nur noch den Tastenkanal, die CPU schlft zwischen den Interrupten
+#define DSPL_OFF_S				120
+
 
 
 // Dallas 1-Wire Bus
 #define ONE_WIRE_ENABLE		1
 
-// Anzahl der untersttzten Gerte
-#define ONE_WIRE_DEV_NO		2
+// Zeitschlitze mit USART0 erzeugen statt Bit-Banging an PC3
+// TXD (PD1) ber Open-Drain-Treiber und RXD (PD0) direkt am Bus,
+// belegt die Segmente A und B -> nur mit genderter Display-Verdrahtung
+#define ONE_WIRE_USART		0
+
+// Anzahl der untersttzten Gerte, max. 8 (Gltigkeits-Bitmaske, 2 Bit Auflsung/Rolle pro Sensor im EEPROM)
+#define ONE_WIRE_DEV_NO		8
+
+// KTY-Kanal K belegt den Messwertplatz ONE_WIRE_DEV_NO - 1 - K, davor ist Platz fr die 1-Wire-Sensoren
+#define ONE_WIRE_ROM_NO		(ONE_WIRE_DEV_NO - ((TEMP_KTY_CH & 0x02) ? 2 : (TEMP_KTY_CH & 0x01)))
+
+// Familiencode der gesuchten Gerte (DS18B20), andere Familien werden bersprungen
+#define ONE_WIRE_FAMILY		0x28
+
+// Bus alle x Sekunden im Hintergrund nach neuen und verschwundenen Sensoren absuchen, 0: nur beim Start
+#define ONE_WIRE_SCAN_S		60
+
+// Suchbits pro Durchlauf der Hauptschleife, jedes Bit kostet 3 Zeitschlitze (ca. 200us)
+#define ONE_WIRE_SCAN_BITS	8
 
 // Kommandos fr Dallas 1-Wire
 #define ONE_WIRE_CMD_SRCH_ROM	0xF0
@@ -70,31 +110,121 @@
 #define ONE_WIRE_CMD_RECALL_EE	0xB8
 #define ONE_WIRE_RD_SUPPLY		0xB4
 
+// 1-Wire-Transaktionen im Hintergrund ber Timer1 abwickeln,
+// 0: blockierend mit _delay_us im Hauptprogramm
+#define ONE_WIRE_ASYNC		1
+
+// Lnge der Transaktions-Warteschlange, muss eine Zweierpotenz sein
+#define ONE_WIRE_QUEUE_NO	4
+
+// Durchlaufzeit der Hauptschleife an PC0 ausgeben (Toggeln), zum Messen mit dem Oszi
+#define MAIN_LOOP_PROBE		0
+
+// Zeit vom Einschalten bis zum ersten gltigen Messwert an PC0 ausgeben (Low -> High),
+// nicht zusammen mit MAIN_LOOP_PROBE
+#define BOOT_TIME_PROBE		0
+
+// bei abgeschalteter Anzeige an PC0 High, solange die CPU wach ist (Tastverhltnis messen),
+// nicht zusammen mit MAIN_LOOP_PROBE oder BOOT_TIME_PROBE
+#define SLEEP_PROBE			0
+
 // Polynom fr die CRC-Berechnung
 #define CRC_1WIRE_POLY		0b00110001
 
+// Berechnung der CRC8
+// 0: bitweise, ca. 100 Takte pro Byte, keine Tabelle
+// 1: zwei Tabellen mit 16 Eintrgen (32 Byte Flash), ca. 25 Takte pro Byte
+// 2: Tabelle mit 256 Eintrgen (256 Byte Flash), ca. 12 Takte pro Byte
+#define CRC_1WIRE_MODE		1
+
 
 
 // ADC
 // Reference Selection
 #define ADMUX_REFSEL		0
 
-// Quellen 0 bis 2
+// 1: Timer0 startet jede Wandlung per Auto-Trigger, der ADC luft immer;
+// 0: die Timer0-ISR startet nur fllige Quellen und schaltet den ADC sonst ab (PRADC)
+#define ADC_TIMER_TRIG		0
+
+// jede Wandlung im ADC Noise Reduction Mode: die Timer0-ISR stellt die Quelle nur ein,
+// die Hauptschleife schlft fr die Dauer der Wandlung (ca. 104s). Timer2 steht dabei,
+// die aktuelle Ziffer leuchtet ohne Schaltflanken weiter. Kommt die Hauptschleife nicht
+// bis zum nchsten Trigger dazu oder laufen gerade 1-Wire-Zeitschlitze (Timer1 und USART
+// stehen im Schlaf), wird normal gewandelt.
+// Erlaubt engere Tastenfenster und krzeres Entprellen, vorher das Rauschen in der
+// Diagnose prfen (Sensoranzeige hinter der Busbelegung)
+#define ADC_NOISE_SLEEP		0
+
+#if ADC_NOISE_SLEEP && ADC_TIMER_TRIG
+#error "ADC_NOISE_SLEEP startet die Wandlung selbst und braucht ADC_TIMER_TRIG 0"
+#endif
+
+// ADC ein, Prescaler 64, Interrupt ein
+#define ADC_CSRA			(_BV(ADEN) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1))
+
+// Quellen 0 bis 2, mit Fotowiderstand 0 bis 3
 #define ADMUX_MIN			0
+#if DSPL_DIM && DSPL_LDR
+#define ADMUX_MAX			3
+#else
 #define ADMUX_MAX			2
+#endif
 
 #define ADC_SRC_NO			(ADMUX_MAX - ADMUX_MIN + 1)
 
+// Tasten hngen an Quelle 2
+#define ADC_KEY_SRC			2
+
+// kein Kanal fllig
+#define ADC_SRC_NONE		0xFF
+
+// Erfassung alle 3 Trigger (12ms), unabhngig davon, welche Quellen gewandelt werden
+#define ADC_ROUND			3
+
+// KTY-Sensoren an Quelle 0 und 1 statt DS18B20, 1 Bit pro Anzeige- bzw. Regelkanal:
+// Bit 0 -> Kanal 1 (Rolle Decke) an ADC0, Bit 1 -> Kanal 2 (Rolle Boden) an ADC1.
+// Spannungsteiler TEMP_KTY_RFIX nach AREF, KTY nach GND, ratiometrisch gemessen
+#define TEMP_KTY_CH			0
+
+// Kennlinie: 81 = KTY81-210 (2k bei 25 C), 84 = KTY84-130 (1k bei 100 C)
+#define TEMP_KTY_TYPE		81
+
+#if TEMP_KTY_TYPE == 84
+#define TEMP_KTY_RFIX		1000
+#else
+#define TEMP_KTY_RFIX		2700
+#endif
+
+// berabtastung: 4^n Werte summieren, durch 2^n teilen -> n Bit mehr (max. 3),
+// bei 83 Hz pro Quelle und n = 2 ein neuer 12-Bit-Wert alle 190ms
+#define TEMP_KTY_OVS_BITS	2
+
+// Abtastteiler der Temperaturquellen in Triggern: mit 1-Wire nur die KTY-Kanle
+#if ONE_WIRE_ENABLE
+#define ADC_DIV_TEMP(K)		((TEMP_KTY_CH & _BV(K)) ? ADC_ROUND : 0)
+#else
+#define ADC_DIV_TEMP(K)		ADC_ROUND
+#endif
+
+// Fotowiderstand alle 100ms, gefiltert wird im Sekundentakt
+#define ADC_DIV_LDR			25
+
+// Tastenkanal bei abgeschalteter Anzeige nur noch zum Aufwecken
+#define ADC_DIV_KEY_OFF		ADC_ROUND
+
 #define TEMP_AVERAGE_NO		16
 
 #if 1
-// ADC wird mit 250Hz getriggert, 3 Quellen
+// ADC wird mit 250Hz getriggert, eine Erfassung alle ADC_ROUND Trigger
 // Aktualisierungsfrequenz 1 Hz
-#define TEMP_UPDATE_COUNT	((250 / 3) * 1)
+#define TEMP_UPDATE_COUNT	((250 / ADC_ROUND) * 1)
 // Blinkfrequenz 3 Hz
-#define TEMP_FLASH_COUNT	((250 / 3) / 3)
+#define TEMP_FLASH_COUNT	((250 / ADC_ROUND) / 3)
 // Sekundenzhler: 250 / 3 = 83 1/3
-#define TEMP_HIST_COUNT		((250 / 3) * 1)
+#define TEMP_HIST_COUNT		((250 / ADC_ROUND) * 1)
+// Dauer einer Erfassung in s: 3 / 250 = 12ms
+#define TEMP_TICK_US		((uint16_t)((1000000UL * ADC_ROUND) / 250))
 
 #else
 // ADC wird mit 625Hz getriggert, 3 Quellen
@@ -104,6 +234,92 @@
 #define TEMP_FLASH_COUNT	((625 / 3) / 3)
 // Sekundenzhler: 625 / 3 = 208 1/3
 #define TEMP_HIST_COUNT		((625 / 3) * 1)
+// Dauer einer Erfassung in s: 3 / 625 = 4.8ms
+#define TEMP_TICK_US		((uint16_t)((1000000UL * 3) / 625))
+#endif
+
+// Konvertierungs-Timeout: 800ms in Erfassungen, danach wird auf jeden Fall gelesen
+#define TEMP_CONV_TIMEOUT	((uint8_t)(800000UL / TEMP_TICK_US))
+
+// Umrechnung der gemessenen Konvertierungszeit von Erfassungen in ms, in 16 Bit gerechnet
+#define TEMP_CONV_TICK_MS(T)	((uint16_t)(T) * (TEMP_TICK_US / 100) / 10)
+
+// Wartezeit in ms (max. 6553) in Erfassungen, aufgerundet, plus eine,
+// weil die erste Erfassung gleich nach dem Start kommen kann
+#define TEMP_MS_TICKS(MS)		((((MS) * 10U) + (TEMP_TICK_US / 100) - 1) / (TEMP_TICK_US / 100) + 1)
+
+// Konvertierungszeit laut Datenblatt (93.75ms << Auflsungscode) in Erfassungen
+#define TEMP_CONV_TICKS(CODE)	TEMP_MS_TICKS(94U << (CODE))
+
+// COPY SCRATCHPAD dauert max. 10ms, ebenso in Erfassungen
+#define TEMP_COPY_TICKS			TEMP_MS_TICKS(10)
+
+// nach RECALL E2 hchstens so oft 8 Lese-Zeitschlitze, bis der Sensor 1 sendet
+#define TEMP_RECALL_POLL		12
+
+// jeden Sensor einzeln konvertieren und abfragen, liefert die Konvertierungszeit je Sensor,
+// 0: alle Sensoren gleichzeitig ber SKIP_ROM, die Zeit gilt dann fr den langsamsten
+#define TEMP_CONV_SINGLE	0
+
+// erste Konvertierung nach dem Start mit 9 Bit (94ms statt 750ms),
+// temp_readDone stellt danach die eingestellte Auflsung wieder her
+#define TEMP_BOOT_FAST		1
+
+// nach jeder Konvertierung nur eine Alarmsuche (ALARM SEARCH), gelesen werden nur Sensoren auerhalb
+// TL...TH (= Schaltschwellen von Kanal 1) und alle TEMP_ALARM_FULL Runden smtliche Sensoren,
+// belegt TH und TL und geht deshalb nur mit TEMP_SENSOR_CAL 0
+#define TEMP_ALARM_MODE		0
+#define TEMP_ALARM_FULL		8
+
+// nur Temperatur-LSB/MSB lesen (ohne CRC, mit Plausibilittsprfung), Abbruch durch den nchsten Reset,
+// alle TEMP_FAST_FULL Runden und bei unplausiblen Werten komplett mit CRC
+#define TEMP_FAST_READ		1
+#define TEMP_FAST_FULL		16
+
+// maximale nderung zwischen zwei kurzen Lesevorgngen in 0,1 C, sonst wird komplett nachgelesen
+#define TEMP_FAST_JUMP		20	// 2 C
+
+// Lesefehler (kein Presence-Pulse, CRC) sofort bis zu TEMP_READ_RETRY mal komplett wiederholen
+#define TEMP_READ_RETRY		2
+
+// danach bleibt der letzte gltige Wert ab dem ersten Fehlschlag noch TEMP_HOLD_S Sekunden stehen
+// (unabhngig von der Auflsung), erst dann gilt der Sensor als ausgefallen und die Ausgnge
+// verwenden nur noch die brigen Sensoren, max. 14
+#define TEMP_HOLD_S			10
+
+// Gesundheitswert 0...100: jeder fehlgeschlagene Leseversuch kostet TEMP_HEALTH_ERR Punkte,
+// jede Sekunde mit gltigem Wert bringt TEMP_HEALTH_ERR Punkte zurck
+#define TEMP_HEALTH_MAX		100
+#define TEMP_HEALTH_ERR		10
+
+// Zustand pro Sensor in je einem Byte, siehe struct temp_sens_s
+#define TEMP_ERR_CRC		0xF0	// CRC-Fehler
+#define TEMP_ERR_PRES		0x0F	// kein Presence-Pulse
+#define TEMP_HEALTH_PEN		0xF0	// Abzug in Schritten von TEMP_HEALTH_ERR
+#define TEMP_HEALTH_HOLD	0x0F	// Sekunden seit dem ersten Fehlschlag + 1, 0 = gltig gelesen
+
+#if TEMP_HOLD_S > 14 || TEMP_HEALTH_MAX / TEMP_HEALTH_ERR > 15
+#error "TEMP_HOLD_S und TEMP_HEALTH_MAX / TEMP_HEALTH_ERR passen nicht in 4 Bit"
+#endif
+
+// Kalibrierung und Rolle im TH/TL-Byte jedes Sensors, also in dessen EEPROM statt im EEPROM des AVR,
+// ein getauschter Fhler bringt seine Werte mit. TH: 101g ggrr, TL: Offset in 1/16 C (-8...+7.9 C)
+// 101 = Kennung, ggg = Verstrkungskorrektur -4...+3 in 1/128, rr = Rolle
+#define TEMP_SENSOR_CAL		1
+
+#define TEMP_CAL_MAGIC			0xA0
+#define TEMP_CAL_MAGIC_MASK		0xE0
+#define TEMP_CAL_ROLE(TH)		((TH) & 0x03)
+#define TEMP_CAL_ROLE_SET(TH, R)	(((TH) & ~0x03) | (R))
+#define TEMP_CAL_GAIN(TH)		((int8_t)((TH) << 3) >> 5)
+#define TEMP_CAL_GAIN_SET(TH, G)	(((TH) & ~0x1C) | (((G) & 0x07) << 2))
+
+#if TEMP_ALARM_MODE && TEMP_CONV_SINGLE
+#error "TEMP_ALARM_MODE braucht die gemeinsame Konvertierung aller Sensoren"
+#endif
+
+#if TEMP_ALARM_MODE && TEMP_SENSOR_CAL
+#error "TEMP_ALARM_MODE und TEMP_SENSOR_CAL brauchen beide TH und TL"
 #endif
 
 // solange muss der Ausgangswert konstant bleiben, bevor das Relais umgeschalten wird
@@ -113,26 +329,35 @@
 #define TEMP_OUTPUT_2_COUNT		60
 
 
-// ADC-Werte fr Tastendruck
-#define ADC_KEY_MENU_MIN	(0x200 - 0x30)	// diese Taste wackelt ziemlich stark
-#define ADC_KEY_MENU_MAX	(0x200 + 0x30)
-
-#define ADC_KEY_UP_MIN		(0x2AA - 0x10)
-#define ADC_KEY_UP_MAX		(0x2AA + 0x10)
+// Toleranz um die Sollwerte der Tasten
+#if ADC_NOISE_SLEEP
+#define ADC_KEY_TOL			0x0C
+#define ADC_KEY_TOL_MENU	0x18
+#else
+#define ADC_KEY_TOL			0x10
+#define ADC_KEY_TOL_MENU	0x30
+#endif
 
-#define ADC_KEY_DOWN_MIN	(0x300 - 0x10)
-#define ADC_KEY_DOWN_MAX	(0x300 + 0x10)
+// ADC-Werte fr Tastendruck, gelten bis zum ersten Einlernen (menu_key_tab)
+#define ADC_KEY_MENU		0x200	// diese Taste wackelt ziemlich stark
+#define ADC_KEY_UP			0x2AA
+#define ADC_KEY_DOWN		0x300
+#define ADC_KEY_OK			0x334
 
-#define ADC_KEY_OK_MIN		(0x334 - 0x10)
-#define ADC_KEY_OK_MAX		(0x334 + 0x10)
+// ohne Taste liegt der Eingang nahe am Vollausschlag, darunter gilt beim Einlernen als gedrckt
+#define ADC_KEY_IDLE		0x380
 
-// wie oft muss eine Taste hintereinander gesampled werden, damit sie gltig ist
+// wie oft muss eine Taste hintereinander gesampled werden, damit sie gltig ist,
+// der Tastenkanal wird bei eingeschalteter Anzeige mit jedem Trigger gewandelt
 #if 0
 // (1 / (625 / 3)) * (20 + 1) = 100.8ms
 #define MENU_KEY_CNT_MIN	20
-#else
-// (1 / (250 / 3)) * (8 + 1) = 100.8ms
+#elif ADC_NOISE_SLEEP
+// (1 / 250) * (8 + 1) = 36ms
 #define MENU_KEY_CNT_MIN	8
+#else
+// (1 / 250) * (12 + 1) = 52ms
+#define MENU_KEY_CNT_MIN	12
 #endif
 
 
@@ -140,6 +365,44 @@
 #define MENU_KEY_UP			_BV(1)
 #define MENU_KEY_DOWN		_BV(2)
 #define MENU_KEY_OK			_BV(3)
+#define MENU_KEY_HOME		_BV(4)	// Zusatztaste: direkt zur Temperaturanzeige
+#define MENU_KEY_LONG		_BV(7)	// zustzlich zu MENU bzw. OK: lange gehalten
+
+// Wiederholung von Hoch/Runter in den Einstellmens, in Tastenwerten zu 4ms nach der ersten Meldung:
+// erste Wiederholung nach (1 / 250) * 100 = 400ms, dann alle (1 / 250) * 20 = 80ms
+#define MENU_KEY_REP_DELAY	100
+#define MENU_KEY_REP_RATE	20
+// nach je 10 Wiederholungen grere Schritte: 1, dann 5, dann 10
+#define MENU_KEY_REP_FAST	10
+#define MENU_KEY_STEP(REP)	(((REP) > 2 * MENU_KEY_REP_FAST - 1) ? 10 : ((REP) > MENU_KEY_REP_FAST - 1) ? 5 : 1)
+
+// MENU bzw. OK lange gehalten: (1 / 250) * (8 + 1 + 240) = 1s, danach nichts mehr bis zum Loslassen
+#define MENU_KEY_LONG_CNT	240
+#define MENU_KEY_DONE		0xFF
+
+// Pltze der Tastentabelle: MENU, UP, DOWN, OK, Zusatztaste, Akkord Hoch+Runter
+#define MENU_KEY_TAB_NO		6
+
+// beim Einschalten eine Taste gedrckt halten: alle Tasten der Reihe nach einlernen
+#define MENU_KEY_CAL		1
+
+// solange muss eine Taste beim Einlernen ruhig liegen: (1 / 250) * 50 = 200ms
+#define MENU_KEY_CAL_CNT	50
+// Zhlerstnde danach: eingelernt, Einlernen beenden, ignorieren - jeweils bis zum Loslassen
+#define MENU_KEY_CAL_NEXT	(MENU_KEY_CAL_CNT + 1)
+#define MENU_KEY_CAL_END	(MENU_KEY_CAL_CNT + 2)
+#define MENU_KEY_CAL_SKIP	(MENU_KEY_CAL_CNT + 3)
+
+// grte Streuung (Spitze-Spitze) einer Taste beim Einlernen in Schritten von ADC >> 2,
+// darber beginnt die Zhlung neu; die wackelige MENU-Taste muss noch durchkommen
+#define MENU_KEY_CAL_SPREAD	(ADC_KEY_TOL_MENU >> 2)
+// Zugabe zur halben Streuung, mindestens bleibt die Toleranz der Standardtabelle
+#define MENU_KEY_CAL_MARGIN	2
+
+// nderungsbits fr menu_printMenu
+#define MENU_CHG_FULL		_BV(0)	// Taste oder Menwechsel: alles neu aufbauen
+#define MENU_CHG_VALUE		_BV(1)	// neue Messwerte: nur genderte Zeilen neu
+#define MENU_CHG_FLASH		_BV(2)	// Blinken: vorberechnete Zeilen nur aus- bzw. einblenden
 
 
 // Grenzwerte fr die Parameter
@@ -151,27 +414,70 @@
 #define TEMP_CFG_CH2_MAX	100
 #define TEMP_CFG_CH2_MIN	0
 
+// Auflsung der DS18B20 in Bit, Konvertierungszeit 94 / 188 / 375 / 750ms
+#define TEMP_CFG_RES_MAX	12
+#define TEMP_CFG_RES_MIN	9
 
-// Quellenauswahl fr den Ausgang
-#define TEMP_SRC_0			0
-#define TEMP_SRC_1			1
-#define TEMP_SRC_0_OR_1		2
-#define TEMP_SRC_DELTA		3
+// Helligkeitsstufe der Anzeige, 0 = automatisch ber den Fotowiderstand
+#if DSPL_DIM && DSPL_LDR
+#define DSPL_CFG_BRIGHT_MIN	0
+#else
+#define DSPL_CFG_BRIGHT_MIN	1
+#endif
+#define DSPL_CFG_BRIGHT_MAX	DSPL_DIM_NO
+
+// im EEPROM 2 Bit pro Sensor, 0 = 9 Bit ... 3 = 12 Bit (gelschtes EEPROM -> 12 Bit)
+#define TEMP_RES_CODE(CFG, I)	(((CFG) >> (2 * (I))) & 0x03)
+
+
+// Rollen der Sensoren, 2 Bit pro Sensor im EEPROM
+#define TEMP_ROLE_CEILING	0
+#define TEMP_ROLE_FLOOR		1
+#define TEMP_ROLE_OUTDOOR	2
+#define TEMP_ROLE_SPARE		3
+
+// Standardbelegung: Sensor 1 an der Decke, Sensor 2 am Boden, alle weiteren in Reserve
+#define TEMP_ROLE_DEFAULT	0xFFF4
+
+// das EEPROM enthlt die Rollen XOR TEMP_ROLE_EE_XOR -> gelschtes EEPROM ergibt die Standardbelegung,
+// ein Block ohne TEMP_CFG_LAYOUT wird beim Laden genauso behandelt
+#define TEMP_ROLE_EE_XOR	(0xFFFF ^ TEMP_ROLE_DEFAULT)
+
+#define TEMP_ROLE_GET(I)	(((temp_ee_cfg.roles ^ TEMP_ROLE_EE_XOR) >> (2 * (I))) & 0x03)
 
-// Temp1 oder Temp2
-#define OUTPUT_CH1_SRC		TEMP_SRC_0_OR_1
+// Quellenauswahl fr den Ausgang: Maske der beteiligten Rollen,
+// ausgewertet wird der grte bzw. kleinste Wert aller Sensoren mit diesen Rollen
+#define TEMP_SRC_ROLE(R)	_BV(R)
+// statt dessen die Differenz zwischen grtem und kleinstem Wert
+#define TEMP_SRC_SPREAD		_BV(7)
 
-// absolute Differenz von Temp1 und Temp2 als Quelle
-#define OUTPUT_CH2_SRC		TEMP_SRC_DELTA
+// Decke oder Boden
+#define OUTPUT_CH1_SRC		(TEMP_SRC_ROLE(TEMP_ROLE_CEILING) | TEMP_SRC_ROLE(TEMP_ROLE_FLOOR))
+
+// absolute Differenz zwischen Decke und Boden als Quelle
+#define OUTPUT_CH2_SRC		(TEMP_SRC_ROLE(TEMP_ROLE_CEILING) | TEMP_SRC_ROLE(TEMP_ROLE_FLOOR) | TEMP_SRC_SPREAD)
 
 // so spart man sich eine Tabelle
 #define OUTPUT_CHx_SRC(CH)	(CH == 0 ? OUTPUT_CH1_SRC : OUTPUT_CH2_SRC)
 
 
 
-// Speicherung der Parameter im EEPROM
+// Speicherung der Parameter im EEPROM, Blcke zu TEMP_CFG_EE_SIZE Byte, davon sizeof(temp_ee_cfg) belegt
 #define TEMP_CFG_EE_COUNT	4
 #define TEMP_CFG_EE_OFFSET	0
+#define TEMP_CFG_EE_SIZE	((size_t)16)
+
+// Kennung des Parameterblocks, weder 0x00 noch 0xFF: ltere Versionen hatten nur 8 Byte
+// mit Platzhaltern ab Byte 5, dort stehen dann noch nur die Schaltschwellen
+#define TEMP_CFG_LAYOUT		0xA5
+
+// gefundene 1-Wire-IDs hinter den Parameterblcken: Anzahl, dann 8 Byte pro Gert
+#define ONE_WIRE_EE_OFFSET	(TEMP_CFG_EE_OFFSET + TEMP_CFG_EE_COUNT * TEMP_CFG_EE_SIZE)
+
+// eingelernte Tastentabelle dahinter: MENU_KEY_TAB_NO als Gltigkeitskennung, dann die Eintrge
+#define MENU_KEY_EE_OFFSET	(ONE_WIRE_EE_OFFSET + 1 + ONE_WIRE_ROM_NO * 8)
+// Zwischenablage beim Einlernen, die gltige Tabelle bleibt bis menu_calEnd unberhrt
+#define MENU_KEY_EE_NEW		(MENU_KEY_EE_OFFSET + 1 + MENU_KEY_TAB_NO * sizeof(struct menu_key_s))
 
 #if 0
 
@@ -187,10 +493,57 @@
 
 #endif
 
+// Min/Max-Verlauf nur fr die beiden Anzeigekanle, als int8 gespeichert
+#define TEMP_HIST_CH_NO	2
+
+#define temp_hist_t		int8_t
+#define TEMP_HIST_MAX	INT8_MAX
+#define TEMP_HIST_MIN	INT8_MIN
+
+#if TEMP_VAL_MAX > INT8_MAX
+// 0.5 C pro Bit, -63.5 ... +63.0 C
+#define TEMP_HIST_TO_VAL(H)		((temp_val_t)(H) * 5)
+#else
+#define TEMP_HIST_TO_VAL(H)		((temp_val_t)(H))
+#endif
+
+// Gltigkeitsbit eines Sensors
+#define TEMP_VALID(I)			(temp_hist.valid & _BV(I))
+
+// Messwertplatz des KTY an Kanal K und umgekehrt, Rolle ist fest TEMP_ROLE_CEILING + K
+#define TEMP_KTY_DEV(K)			(ONE_WIRE_DEV_NO - 1 - (K))
+#define TEMP_KTY_IS(DEV)		(TEMP_KTY_CH & _BV(ONE_WIRE_DEV_NO - 1 - (DEV)))
+
+// Messwerte in 0,1 C bzw. 1 C
+#if TEMP_VAL_MAX > INT8_MAX
+#define TEMP_KTY_UNIT			10
+#else
+#define TEMP_KTY_UNIT			1
+#endif
+
+// ADC-Wert des Spannungsteilers nach der berabtastung
+#define TEMP_KTY_ADC(R)			((uint16_t)(((1024UL << TEMP_KTY_OVS_BITS) * (R)) / ((R) + TEMP_KTY_RFIX)))
+
+// Sttzstelle im 10 C-Raster: ADC-Wert bei R0 und Steigung bis R1 in Einheiten / 256 LSB,
+// damit kommt die Interpolation ohne Division aus
+#define TEMP_KTY_SEG(R0, R1)	{ TEMP_KTY_ADC(R0),	\
+	(uint16_t)(((10UL * TEMP_KTY_UNIT * 256) + (TEMP_KTY_ADC(R1) - TEMP_KTY_ADC(R0)) / 2) / (TEMP_KTY_ADC(R1) - TEMP_KTY_ADC(R0))) }
+
+// Temperatur der ersten Sttzstelle
+#define TEMP_KTY_T_MIN			(-30)
+
 /*---------------------------Aliase fr Pins und Ports-----------------------*/
 
 #define DIGIT_NO			8
 
+// bergabe des Segmentspeichers an die Multiplex-ISR, siehe dspl.swap
+#define DSPL_SWAP_NONE		0	// nichts Neues
+#define DSPL_SWAP_READY		1	// Bild fertig, wird am Ende des laufenden Bildes bernommen
+#define DSPL_SWAP_WRITE		2	// Hauptprogramm schreibt gerade, dspl_commit gibt frei
+
+// der Compiler darf Zugriffe auf den Segmentspeicher nicht ber diese Stelle verschieben
+#define DSPL_BARRIER		__asm__ __volatile__ ("" ::: "memory")
+
 // hngt alles schn der Reihe nach an PortD
 #define SEGMENT_A			_BV(PD0)
 #define SEGMENT_B			_BV(PD1)
@@ -201,6 +554,19 @@
 #define SEGMENT_G			_BV(PD6)
 #define SEGMENT_DP			_BV(PD7)
 
+#if DSPL_MAX7219
+// LOAD an PB2 (SS), DIN an MOSI (PB3), CLK an SCK (PB5)
+#define MAX7219_LOAD		_BV(PB2)
+
+// Register des MAX7219, Ziffern 0 bis 7 auf 0x01 bis 0x08
+#define MAX7219_DIGIT0		0x01
+#define MAX7219_DECODE		0x09
+#define MAX7219_INTENSITY	0x0A
+#define MAX7219_SCAN_LIMIT	0x0B
+#define MAX7219_SHUTDOWN	0x0C
+#define MAX7219_TEST		0x0F
+#endif
+
 // Ausgnge
 #define OUTPUT_CHx_REG		PORTC
 #define OUTPUT_CH1_BIT		_BV(PC4)
@@ -232,6 +598,23 @@
 // Wert des PortPins lesen
 #define ONE_WIRE_READ		(PINC & _BV(PC3))
 
+#if ONE_WIRE_USART
+// der Open-Drain-Treiber an TXD kann den Bus nicht aktiv auf 1 ziehen,
+// parasitr versorgte Sensoren brauchen dann einen externen Transistor
+#define ONE_WIRE_SPU_ON		{}
+#define ONE_WIRE_SPU_OFF	{}
+#else
+// starker Pull-Up whrend der Konvertierung parasitr versorgter Sensoren: PortPin auf 1 und als Ausgang
+#define ONE_WIRE_SPU_ON		{PORTC |= _BV(PC3); DDRC |= _BV(PC3);}
+
+// wieder loslassen, ONE_WIRE_OUT braucht die 0 im PORT-Register
+#define ONE_WIRE_SPU_OFF	{DDRC &= ~_BV(PC3); PORTC &= ~_BV(PC3);}
+#endif
+
+// Busbelegung in 10us fr die Statistik: Reset (H + I + J) und ein Zeitschlitz
+#define ONE_WIRE_TIME_RESET			96
+#define ONE_WIRE_TIME_SLOT			7
+
 // Standard-Verzgerungen laut AppNote 126
 #define ONE_WIRE_DELAY_A			_delay_us(6)
 #define ONE_WIRE_DELAY_B			_delay_us(64)
@@ -244,17 +627,76 @@
 #define ONE_WIRE_DELAY_I			_delay_us(70)
 #define ONE_WIRE_DELAY_J			_delay_us(410)
 
+// Abtastzeitpunkt des Presence-Pulses im Timer1-Betrieb in s nach dem Loslassen:
+// der Sensor zieht den Bus sptestens nach 60s und mindestens bis 75s auf low,
+// 64s lassen noch 11s Versptung durch eine gerade laufende andere ISR zu
+#define ONE_WIRE_TIME_PRESENCE		64
+
+/*
+ * Zeitkritische Abschnitte der Zeitschlitze
+ *
+ * Kritisch sind nur die Abschnitte, in denen eine Verzgerung durch einen
+ * Interrupt das Ergebnis verflscht: der 6s Low-Puls eines 1-Bits und der
+ * Abtastzeitpunkt 15s nach Beginn eines Lese-Zeitschlitzes bzw. 70s nach
+ * dem Reset. Diese Abschnitte laufen mit gesperrten Interrupts, der Rest
+ * (480s Reset, 60s Low-Puls eines 0-Bits, Recovery) darf sich verlngern.
+ *
+ * Zustzliche Verzgerung des Display-Multiplex (Timer2, alle 1,6ms):
+ * - synchron: max. ca. 16s pro Zeitschlitz, ca. 72s beim Presence-Puls
+ * - Timer1: max. ca. 20s (Lese-Zeitschlitz komplett in der ISR)
+ * - USART: die Hardware erzeugt die Zeitschlitze, die RX-ISR ist kurz
+ * Im schlimmsten Fall ist eine Stelle 72s = 4,5% krzer an, das ist
+ * nicht sichtbar.
+ */
+
+#if ONE_WIRE_USART
+// Bitraten mit U2X0: 9600 Baud fr Reset/Presence, 115200 Baud fr die Zeitschlitze
+#define ONE_WIRE_UBRR(BAUD)			((F_CPU + 4UL * (BAUD)) / (8UL * (BAUD)) - 1)
+#define ONE_WIRE_UBRR_RESET			ONE_WIRE_UBRR(9600)
+#define ONE_WIRE_UBRR_SLOT			ONE_WIRE_UBRR(115200)
+#endif
+
 #endif
 
 /*---------------------------Variablen---------------------------------------*/
 
 struct display_data
 {
-	volatile uint8_t	digit;			/*!< aktive Stelle */
+#if !DSPL_MAX7219
+	uint8_t				*ptr;			/*!< nchstes Portbyte-Paar fr die Multiplex-ISR */
+#endif
+	volatile uint8_t	swap;			/*!< DSPL_SWAP_NONE, DSPL_SWAP_READY oder DSPL_SWAP_WRITE */
+	uint8_t				blank;			/*!< ausgeblendete Zeilen, 1 Bit pro Zeile */
+	uint8_t				off;			/*!< Anzeige abgeschaltet, Timer2 steht */
 	uint8_t				mem[DIGIT_NO];	/*!< Zeichenspeicher */
-	uint8_t				seg[DIGIT_NO];	/*!< Segmentspeicher */
+	uint8_t				seg[DIGIT_NO];	/*!< Segmentspeicher, wird im Hauptprogramm beschrieben */
+#if DSPL_MAX7219
+	uint8_t				sent[DIGIT_NO];	/*!< zuletzt an den MAX7219 bertragene Segmente */
+#elif DSPL_DIM
+	uint8_t				port[DIGIT_NO][3];	/*!< angezeigtes Bild: PORTD, PORTB und OCR2B je Stelle */
+#else
+	uint8_t				port[DIGIT_NO][2];	/*!< angezeigtes Bild: PORTD und PORTB je Stelle */
+#endif
+#if DSPL_DIM && DSPL_LDR
+	uint16_t			ldr;			/*!< gefilterter Messwert des Fotowiderstands, 64-fach */
+#endif
 } dspl;
 
+#if DSPL_DIM && DSPL_MAX7219
+// Intensity-Register je Helligkeitsstufe, Tastverhltnis (2 * n + 1) / 32
+const uint8_t dspl_dim_tab[DSPL_DIM_NO] PROGMEM =
+{
+	0, 1, 2, 3, 5, 7, 10, 15
+};
+#elif DSPL_DIM
+// Einschaltdauer je Helligkeitsstufe in Timer2-Takten (32s) vom Zeitfenster
+// TIMER2_OCRA + 1, grob logarithmisch; 0xFF wird nie erreicht -> volle Helligkeit
+const uint8_t dspl_dim_tab[DSPL_DIM_NO] PROGMEM =
+{
+	1, 2, 3, 5, 8, 13, 25, 0xFF
+};
+#endif
+
 
 /*
 	 --		 A
@@ -361,15 +803,35 @@ enum digit_list
 
 struct adc_data_s
 {
-	uint8_t		source;				/*!< Quelle */
-	uint8_t		complete;			/*!< wird nach Erfassung aller Quellen 1 */
+	uint8_t		trig;				/*!< Trigger seit der letzten Erfassung */
+	uint8_t		complete;			/*!< wird alle ADC_ROUND Trigger 1 */
+	uint8_t		key_new;			/*!< wird nach jeder Wandlung des Tastenkanals 1 */
+
+	uint8_t		div[ADC_SRC_NO];	/*!< Abtastteiler in Triggern, 0 = Quelle aus */
+	uint8_t		cnt[ADC_SRC_NO];	/*!< Trigger bis zur nchsten Wandlung, 0 = fllig */
 
 	uint16_t	mem[ADC_SRC_NO];	/*!< Speicher fr die aktuellen Ergebnisse */
+#if ADC_NOISE_SLEEP
+	uint8_t		sleep;				/*!< Quelle eingestellt, die Wandlung startet mit dem Einschlafen */
+#endif
 };
 
 // alles wird auch in der ISR beschrieben
 volatile struct adc_data_s		adc_data;
 
+// Abtastteiler je Quelle, Zeile 0 bei eingeschalteter, Zeile 1 bei abgeschalteter Anzeige;
+// der Tastenkanal bekommt alle Trigger, die keine andere Quelle braucht
+const uint8_t adc_div_tab[2][ADC_SRC_NO] PROGMEM =
+{
+#if DSPL_DIM && DSPL_LDR
+	{ ADC_DIV_TEMP(0), ADC_DIV_TEMP(1), 1, ADC_DIV_LDR },
+	{ ADC_DIV_TEMP(0), ADC_DIV_TEMP(1), ADC_DIV_KEY_OFF, 0 }
+#else
+	{ ADC_DIV_TEMP(0), ADC_DIV_TEMP(1), 1 },
+	{ ADC_DIV_TEMP(0), ADC_DIV_TEMP(1), ADC_DIV_KEY_OFF }
+#endif
+};
+
 #if ONE_WIRE_ENABLE
 // keine Mittelwertbildung mehr
 #else
@@ -387,6 +849,61 @@ struct temp_average_data
 #endif
 #endif
 
+#if TEMP_KTY_CH || !ONE_WIRE_ENABLE
+struct temp_kty_seg
+{
+	uint16_t	adc;		/*!< ADC-Wert am Anfang des Abschnitts */
+	uint16_t	slope;		/*!< Steigung, siehe TEMP_KTY_SEG */
+};
+
+// stckweise lineare Kennlinie von -30 bis +100 C, typische Widerstnde aus dem Datenblatt;
+// die letzte Sttzstelle begrenzt nur den Bereich
+const struct temp_kty_seg temp_kty_tab[] PROGMEM =
+{
+#if TEMP_KTY_TYPE == 84
+	TEMP_KTY_SEG( 391,  424),	// -30 C
+	TEMP_KTY_SEG( 424,  460),
+	TEMP_KTY_SEG( 460,  498),
+	TEMP_KTY_SEG( 498,  538),	//   0 C
+	TEMP_KTY_SEG( 538,  581),
+	TEMP_KTY_SEG( 581,  626),
+	TEMP_KTY_SEG( 626,  672),
+	TEMP_KTY_SEG( 672,  722),
+	TEMP_KTY_SEG( 722,  773),	//  50 C
+	TEMP_KTY_SEG( 773,  826),
+	TEMP_KTY_SEG( 826,  882),
+	TEMP_KTY_SEG( 882,  940),
+	TEMP_KTY_SEG( 940, 1000),
+	{ TEMP_KTY_ADC(1000), 0 },	// 100 C
+#else
+	TEMP_KTY_SEG(1247, 1367),	// -30 C
+	TEMP_KTY_SEG(1367, 1495),
+	TEMP_KTY_SEG(1495, 1630),
+	TEMP_KTY_SEG(1630, 1772),	//   0 C
+	TEMP_KTY_SEG(1772, 1922),
+	TEMP_KTY_SEG(1922, 2080),
+	TEMP_KTY_SEG(2080, 2245),
+	TEMP_KTY_SEG(2245, 2417),
+	TEMP_KTY_SEG(2417, 2597),	//  50 C
+	TEMP_KTY_SEG(2597, 2785),
+	TEMP_KTY_SEG(2785, 2980),
+	TEMP_KTY_SEG(2980, 3182),
+	TEMP_KTY_SEG(3182, 3392),
+	{ TEMP_KTY_ADC(3392), 0 },	// 100 C
+#endif
+};
+
+#define TEMP_KTY_TAB_NO		(sizeof(temp_kty_tab) / sizeof(temp_kty_tab[0]))
+#endif
+
+#if TEMP_KTY_CH
+struct temp_kty_data
+{
+	uint16_t	sum[TEMP_HIST_CH_NO];	/*!< Summe der berabtastung */
+	uint8_t		cnt;					/*!< Anzahl summierter Werte */
+} temp_kty;
+#endif
+
 struct temp_history
 {
 	uint8_t		cnt;		/*!< Erfassungszhler */
@@ -397,13 +914,15 @@ struct temp_history
 
 	uint8_t		index;		/*!< Arrayindex */
 
-	uint8_t		valid[2];	/*!< Messwert ist gltig */
+	uint8_t		valid;		/*!< Messwert ist gltig, 1 Bit pro Sensor */
 
-	temp_val_t	value[2];	/*!< aktuelle Werte */
+	temp_val_t	value[ONE_WIRE_DEV_NO];	/*!< aktuelle Werte */
 
-	// Min/Max-Werte der letzten 24 Stunden
-	temp_val_t	min_array[2][24];
-	temp_val_t	max_array[2][24];
+	uint8_t		chan[TEMP_HIST_CH_NO];	/*!< Sensor der Anzeigekanle, 0xFF = keiner */
+
+	// Min/Max-Werte der letzten 24 Stunden, siehe TEMP_HIST_TO_VAL
+	temp_hist_t	min_array[TEMP_HIST_CH_NO][24];
+	temp_hist_t	max_array[TEMP_HIST_CH_NO][24];
 
 #if 0
 	// Min/Max-Werte der letzten 6/12/24 Stunden
@@ -423,7 +942,14 @@ struct temp_config_data
 	int8_t		ch2_on;		/*!< Kanal 2 ein */
 	int8_t		ch2_off;	/*!< Kanal 2 aus */
 
-	uint8_t		reserved[8 - 5];	/*!< Platzhalter */
+	uint8_t		layout;		/*!< TEMP_CFG_LAYOUT, sonst gilt nur, was davor steht */
+
+	uint16_t	resolution;	/*!< Auflsung der Sensoren, TEMP_RES_CODE */
+	uint16_t	roles;		/*!< Rollen der Sensoren, TEMP_ROLE_GET */
+
+	uint8_t		bright;		/*!< Helligkeitsstufe der Anzeige */
+
+	// Rest bis TEMP_CFG_EE_SIZE bleibt im EEPROM frei und wird nicht gespiegelt
 
 } temp_ee_cfg;
 
@@ -436,6 +962,11 @@ enum PARA_LIST
 	CFG_PARA_CH1_OFF,
 	CFG_PARA_CH2_OFF,
 
+	CFG_PARA_RES1,
+	CFG_PARA_RES2,
+
+	CFG_PARA_BRIGHT,
+
 	CFG_PARA_END,
 	MENU_PARA_START		= CFG_PARA_END,
 
@@ -447,6 +978,9 @@ enum PARA_LIST
 	MENU_PARA_MIN_CH1,
 	MENU_PARA_MIN_CH2,
 
+	MENU_PARA_SENSOR,
+	MENU_PARA_DIAG,
+	MENU_PARA_CAL,
 
 #if 0
 	MENU_PARA_SECONDS,
@@ -456,7 +990,10 @@ enum PARA_LIST
 
 	MENU_PARA_END,
 
-	PARA_NO = MENU_PARA_END
+	PARA_NO = MENU_PARA_END,
+
+	// Einstellmen ohne Vergleichsparameter
+	PARA_NO_CMP
 };
 
 
@@ -469,15 +1006,38 @@ struct config_data
 } temp_cfg;
 
 
+struct menu_key_s
+{
+	uint8_t		center;		/*!< Sollwert der Taste, ADC >> 2 */
+	uint8_t		tol;		/*!< zulssige Abweichung, 0 = Platz unbenutzt */
+	uint8_t		code;		/*!< MENU_KEY_*, bei Akkorden mehrere Bits */
+};
+
 struct menu_data
 {
 	uint8_t		menu;		/*!< aktives Men */
-	uint8_t		changed;	/*!< nderungen an Anzeige oder Men */
+	uint8_t		changed;	/*!< nderungen an Anzeige oder Men, MENU_CHG_x */
 	uint8_t		flash;		/*!< wechselt beim Blinken */
+	uint8_t		flash_rows;	/*!< blinkende Zeilen, 1 Bit pro Zeile */
+	uint8_t		shown;		/*!< Zeilen mit gltigem shown_val, 1 Bit pro Zeile */
+	temp_val_t	shown_val[TEMP_HIST_CH_NO];	/*!< zuletzt angezeigter Messwert je Zeile */
+
+	uint8_t		idle;		/*!< Sekunden seit dem letzten Tastendruck, siehe DSPL_OFF_S */
+
+	uint16_t	key_min;	/*!< kleinster Rohwert des Tastenkanals in dieser Sekunde */
+	uint16_t	key_max;	/*!< grter Rohwert des Tastenkanals in dieser Sekunde */
+	uint8_t		key_pp;		/*!< Rauschen der letzten Sekunde, Spitze-Spitze in LSB */
 
 	uint8_t		key;		/*!< Tastendruck */
 	uint8_t		keyLast;	/*!< vorhergehender Tastenmesswert */
 	uint8_t		keyCnt;		/*!< Anzahl identischer Tastenmesswerte */
+	uint8_t		keyRep;		/*!< Wiederholungen der gehaltenen Taste, bestimmt die Schrittweite */
+	uint8_t		keyEE;		/*!< eingelernte Tabelle im EEPROM gltig, sonst menu_key_tab, siehe menu_loadKeys */
+#if MENU_KEY_CAL
+	uint8_t		kcal;		/*!< eingelernter Platz der Tastentabelle + 1, 0 = normaler Betrieb */
+	uint8_t		kcalMin;	/*!< kleinster Rohwert der Taste beim Einlernen */
+	uint8_t		kcalMax;	/*!< grter Rohwert der Taste beim Einlernen */
+#endif
 
 //	uint8_t		parMenu;	/*!< Parameter Taste 1 */
 //	uint8_t		parUp;		/*!< Parameter Taste 2 */
@@ -485,6 +1045,9 @@ struct menu_data
 //	uint8_t		parOk;		/*!< Parameter Taste 4 */
 
 	uint8_t		minMaxId;	/*!< Index fr MinMaxArrays */
+	uint8_t		sensor;		/*!< angezeigter Sensor in MENU_TEMP_SENSOR */
+	uint8_t		diag;		/*!< angezeigter Wert in MENU_TEMP_DIAG */
+	uint8_t		cal;		/*!< 0 = Offset, 1 = Verstrkung in MENU_TEMP_CAL */
 
 	uint8_t		cnt_update;		/*!< Zhler fr Aktualisierung */
 	uint8_t		cnt_flash;		/*!< Zhler frs Blinken */
@@ -492,6 +1055,17 @@ struct menu_data
 
 } menu_cfg;
 
+// Standardtabelle, die beiden letzten Pltze werden erst durch Einlernen belegt
+const struct menu_key_s menu_key_tab[MENU_KEY_TAB_NO] PROGMEM =
+{
+	{ ADC_KEY_MENU >> 2,	ADC_KEY_TOL_MENU >> 2,	MENU_KEY_MENU				},
+	{ ADC_KEY_UP >> 2,		ADC_KEY_TOL >> 2,		MENU_KEY_UP					},
+	{ ADC_KEY_DOWN >> 2,	ADC_KEY_TOL >> 2,		MENU_KEY_DOWN				},
+	{ ADC_KEY_OK >> 2,		ADC_KEY_TOL >> 2,		MENU_KEY_OK					},
+	{ 0,					0,						MENU_KEY_HOME				},
+	{ 0,					0,						MENU_KEY_UP | MENU_KEY_DOWN	},
+};
+
 const uint8_t text_tab[][4] PROGMEM =
 {
 	//	+/- 1/2			1				2				3
@@ -507,6 +1081,11 @@ const uint8_t text_tab[][4] PROGMEM =
 
 	{	DIGIT_P0,		DIGIT_MINUS,	DIGIT_MINUS,	DIGIT_MINUS	},
 	{	DIGIT_M0,		DIGIT_MINUS,	DIGIT_MINUS,	DIGIT_MINUS	},
+
+	{	DIGIT_BLANK,	DIGIT_R,		DIGIT_E,		DIGIT_1		},
+	{	DIGIT_BLANK,	DIGIT_R,		DIGIT_E,		DIGIT_2		},
+
+	{	DIGIT_BLANK,	DIGIT_H,		DIGIT_E,		DIGIT_L		},
 };
 
 enum TEXT_LIST
@@ -524,6 +1103,11 @@ enum TEXT_LIST
 	TEXT_ID_OVF_PLUS,
 	TEXT_ID_OVF_MINUS,
 
+	TEXT_ID_RES1,
+	TEXT_ID_RES2,
+
+	TEXT_ID_BRIGHT,
+
 	TEXT_ID_NO
 };
 
@@ -553,6 +1137,9 @@ enum MENU_LIST
 	MENU_TEMP_MIN_CH1,
 	MENU_TEMP_MIN_CH2,
 
+	MENU_TEMP_SENSOR,
+	MENU_TEMP_DIAG,
+	MENU_TEMP_CAL,
 #if 0
 	MENU_SELECT_HOURS,
 	MENU_SELECT_MINUTES,
@@ -565,6 +1152,11 @@ enum MENU_LIST
 	MENU_SELECT_CH2_ON,
 	MENU_SELECT_CH2_OFF,
 
+	MENU_SELECT_RES1,
+	MENU_SELECT_RES2,
+
+	MENU_SELECT_BRIGHT,
+
 
 	MENU_EDIT_CH1_ON,
 	MENU_EDIT_CH1_OFF,
@@ -572,19 +1164,33 @@ enum MENU_LIST
 	MENU_EDIT_CH2_ON,
 	MENU_EDIT_CH2_OFF,
 
+	MENU_EDIT_RES1,
+	MENU_EDIT_RES2,
+
+	MENU_EDIT_BRIGHT,
+
 
 	MENU_NO
 };
 
+#if DSPL_DIM
+#define MENU_SELECT_LAST		MENU_SELECT_BRIGHT
+#else
+#define MENU_SELECT_LAST		MENU_SELECT_RES2
+#endif
+
+// letztes Einstellmen, dazwischen wird geblinkt
+#define MENU_EDIT_LAST			MENU_EDIT_BRIGHT
+
 #if 1
-#define MENU_SELECT_SECONDS		MENU_SELECT_CH2_OFF
+#define MENU_SELECT_SECONDS		MENU_SELECT_LAST
 #define MENU_SELECT_HOURS		MENU_SELECT_CH1_ON
 #endif
 
 const struct menu_setup_s menu_setup_tab[MENU_NO] PROGMEM =
 {
 	//							Text				MENU				UP						DOWN					OK						para				para_cmp			para_min			para_max
-	/* MENU_TEMP_VALUE */		{TEXT_ID_NO,		MENU_SELECT_CH1_ON,	MENU_TEMP_MAX_CH1,		MENU_TEMP_MIN_CH1,		MENU_NO,				MENU_PARA_TEMP,		},
+	/* MENU_TEMP_VALUE */		{TEXT_ID_NO,		MENU_SELECT_CH1_ON,	MENU_TEMP_MAX_CH1,		MENU_TEMP_MIN_CH1,		MENU_TEMP_SENSOR,		MENU_PARA_TEMP,		},
 
 	/* MENU_TEMP_MAX_CH1 */		{TEXT_ID_NO,		MENU_NO,			MENU_TEMP_MAX_CH2,		MENU_TEMP_VALUE,		MENU_NO,				MENU_PARA_MAX_CH1,	},
 	/* MENU_TEMP_MAX_CH2 */		{TEXT_ID_NO,		MENU_NO,			MENU_NO,				MENU_TEMP_MAX_CH1,		MENU_NO,				MENU_PARA_MAX_CH2,	},
@@ -592,6 +1198,14 @@ const struct menu_setup_s menu_setup_tab[MENU_NO] PROGMEM =
 	/* MENU_TEMP_MIN_CH1 */		{TEXT_ID_NO,		MENU_NO,			MENU_TEMP_VALUE,		MENU_TEMP_MIN_CH2,		MENU_NO,				MENU_PARA_MIN_CH1,	},
 	/* MENU_TEMP_MIN_CH2 */		{TEXT_ID_NO,		MENU_NO,			MENU_TEMP_MIN_CH1,		MENU_NO,				MENU_NO,				MENU_PARA_MIN_CH2,	},
 
+	/* MENU_TEMP_SENSOR */		{TEXT_ID_NO,		MENU_TEMP_DIAG,		MENU_NO,				MENU_NO,				MENU_NO,				MENU_PARA_SENSOR,	},
+#if TEMP_SENSOR_CAL
+	/* MENU_TEMP_DIAG */		{TEXT_ID_NO,		MENU_TEMP_CAL,		MENU_NO,				MENU_NO,				MENU_NO,				MENU_PARA_DIAG,		},
+#else
+	/* MENU_TEMP_DIAG */		{TEXT_ID_NO,		MENU_TEMP_VALUE,	MENU_NO,				MENU_NO,				MENU_NO,				MENU_PARA_DIAG,		},
+#endif
+	/* MENU_TEMP_CAL */			{TEXT_ID_NO,		MENU_TEMP_VALUE,	MENU_NO,				MENU_NO,				MENU_NO,				MENU_PARA_CAL,		},
+
 #if 0
 	/* MENU_SELECT_HOURS */		{TEXT_ID_CH1_ON,	MENU_TEMP_VALUE,	MENU_SELECT_CH2_OFF,	MENU_SELECT_MINUTES,	MENU_NO,				MENU_PARA_HOURS,	PARA_NO,	},
 	/* MENU_SELECT_MINUTES */	{TEXT_ID_CH1_ON,	MENU_TEMP_VALUE,	MENU_SELECT_HOURS,		MENU_SELECT_SECONDS,	MENU_NO,				MENU_PARA_MINUTES,	PARA_NO,	},
@@ -602,7 +1216,16 @@ const struct menu_setup_s menu_setup_tab[MENU_NO] PROGMEM =
 	/* MENU_SELECT_CH1_OFF */	{TEXT_ID_CH1_OFF,	MENU_TEMP_VALUE,	MENU_SELECT_CH1_ON,		MENU_SELECT_CH2_ON,		MENU_EDIT_CH1_OFF,		CFG_PARA_CH1_OFF,	PARA_NO,	},
 
 	/* MENU_SELECT_CH2_ON */	{TEXT_ID_CH2_ON,	MENU_TEMP_VALUE,	MENU_SELECT_CH1_OFF,	MENU_SELECT_CH2_OFF,	MENU_EDIT_CH2_ON,		CFG_PARA_CH2_ON,	PARA_NO,	},
-	/* MENU_SELECT_CH2_OFF */	{TEXT_ID_CH2_OFF,	MENU_TEMP_VALUE,	MENU_SELECT_CH2_ON,		MENU_SELECT_HOURS,		MENU_EDIT_CH2_OFF,		CFG_PARA_CH2_OFF,	PARA_NO,	},
+	/* MENU_SELECT_CH2_OFF */	{TEXT_ID_CH2_OFF,	MENU_TEMP_VALUE,	MENU_SELECT_CH2_ON,		MENU_SELECT_RES1,		MENU_EDIT_CH2_OFF,		CFG_PARA_CH2_OFF,	PARA_NO,	},
+
+	/* MENU_SELECT_RES1 */		{TEXT_ID_RES1,		MENU_TEMP_VALUE,	MENU_SELECT_CH2_OFF,	MENU_SELECT_RES2,		MENU_EDIT_RES1,			CFG_PARA_RES1,		PARA_NO,	},
+#if DSPL_DIM
+	/* MENU_SELECT_RES2 */		{TEXT_ID_RES2,		MENU_TEMP_VALUE,	MENU_SELECT_RES1,		MENU_SELECT_BRIGHT,		MENU_EDIT_RES2,			CFG_PARA_RES2,		PARA_NO,	},
+#else
+	/* MENU_SELECT_RES2 */		{TEXT_ID_RES2,		MENU_TEMP_VALUE,	MENU_SELECT_RES1,		MENU_SELECT_HOURS,		MENU_EDIT_RES2,			CFG_PARA_RES2,		PARA_NO,	},
+#endif
+
+	/* MENU_SELECT_BRIGHT */	{TEXT_ID_BRIGHT,	MENU_TEMP_VALUE,	MENU_SELECT_RES2,		MENU_SELECT_HOURS,		MENU_EDIT_BRIGHT,		CFG_PARA_BRIGHT,	PARA_NO,	},
 
 
 	/* MENU_EDIT_CH1_ON */		{TEXT_ID_CH1_ON,	MENU_SELECT_CH1_ON,		MENU_NO,			MENU_NO,				MENU_SELECT_CH1_ON,		CFG_PARA_CH1_ON,	CFG_PARA_CH1_OFF,	TEMP_CFG_CH1_MIN,	TEMP_CFG_CH1_MAX	},
@@ -610,18 +1233,116 @@ const struct menu_setup_s menu_setup_tab[MENU_NO] PROGMEM =
 
 	/* MENU_EDIT_CH2_ON */		{TEXT_ID_CH2_ON,	MENU_SELECT_CH2_ON,		MENU_NO,			MENU_NO,				MENU_SELECT_CH2_ON,		CFG_PARA_CH2_ON,	CFG_PARA_CH2_OFF,	TEMP_CFG_CH2_MIN,	TEMP_CFG_CH2_MAX	},
 	/* MENU_EDIT_CH2_OFF */		{TEXT_ID_CH2_OFF,	MENU_SELECT_CH2_OFF,	MENU_NO,			MENU_NO,				MENU_SELECT_CH2_OFF,	CFG_PARA_CH2_OFF,	CFG_PARA_CH2_ON,	TEMP_CFG_CH2_MIN,	TEMP_CFG_CH2_MAX	},
+
+	/* MENU_EDIT_RES1 */		{TEXT_ID_RES1,		MENU_SELECT_RES1,		MENU_NO,			MENU_NO,				MENU_SELECT_RES1,		CFG_PARA_RES1,		PARA_NO_CMP,		TEMP_CFG_RES_MIN,	TEMP_CFG_RES_MAX	},
+	/* MENU_EDIT_RES2 */		{TEXT_ID_RES2,		MENU_SELECT_RES2,		MENU_NO,			MENU_NO,				MENU_SELECT_RES2,		CFG_PARA_RES2,		PARA_NO_CMP,		TEMP_CFG_RES_MIN,	TEMP_CFG_RES_MAX	},
+
+	/* MENU_EDIT_BRIGHT */		{TEXT_ID_BRIGHT,	MENU_SELECT_BRIGHT,		MENU_NO,			MENU_NO,				MENU_SELECT_BRIGHT,		CFG_PARA_BRIGHT,	PARA_NO_CMP,		DSPL_CFG_BRIGHT_MIN,	DSPL_CFG_BRIGHT_MAX	},
 };
 
 #if ONE_WIRE_ENABLE
+// Ablaufsteuerung einer Transaktion
+#define ONE_WIRE_JOB_RESET		_BV(0)	/*!< vorher Reset, Presence-Pulse prfen */
+#define ONE_WIRE_JOB_CRC		_BV(1)	/*!< CRC ber die gelesenen Bytes prfen */
+#define ONE_WIRE_JOB_SPU		_BV(2)	/*!< danach starker Pull-Up, bis ONE_WIRE_SPU_OFF */
+
+enum ONE_WIRE_JOB_STATUS
+{
+	ONE_WIRE_JOB_IDLE,			/*!< noch nie gestartet */
+	ONE_WIRE_JOB_QUEUED,		/*!< wartet in der Warteschlange */
+	ONE_WIRE_JOB_BUSY,			/*!< wird gerade bertragen */
+	ONE_WIRE_JOB_DONE,			/*!< erfolgreich beendet */
+	ONE_WIRE_JOB_ERR_PRESENCE,	/*!< kein Presence-Pulse nach dem Reset */
+	ONE_WIRE_JOB_ERR_CRC,		/*!< CRC der gelesenen Bytes falsch */
+};
+
+// Transaktion eingereiht oder luft noch, darf nicht neu belegt werden
+#define ONE_WIRE_JOB_PENDING(job) ((job).status == ONE_WIRE_JOB_QUEUED || (job).status == ONE_WIRE_JOB_BUSY)
+
+// Ergebnis von oneWire_srchStep
+enum ONE_WIRE_SRCH
+{
+	ONE_WIRE_SRCH_BUSY,			/*!< ID noch nicht komplett */
+	ONE_WIRE_SRCH_FOUND,		/*!< ID in srch_rom */
+	ONE_WIRE_SRCH_END,			/*!< keine weiteren Gerte der Familie */
+};
+
+struct oneWire_job_s
+{
+	uint8_t			flags;		/*!< ONE_WIRE_JOB_RESET, ONE_WIRE_JOB_CRC */
+	uint8_t			wr_count;	/*!< Anzahl zu schreibender Bytes */
+	uint8_t			rd_count;	/*!< Anzahl zu lesender Bytes */
+	const uint8_t	*wr_data;	/*!< Quelle fr die zu schreibenden Bytes */
+	uint8_t			*rd_data;	/*!< Ziel fr die gelesenen Bytes */
+
+	void			(*done)(struct oneWire_job_s *job);	/*!< Rckruf im Hauptprogramm, darf 0 sein */
+
+	volatile uint8_t	status;	/*!< ONE_WIRE_JOB_STATUS */
+};
+
+#if ONE_WIRE_ASYNC
+// Rckgabe von oneWire_jobBit: alle Bits bertragen
+#define ONE_WIRE_JOB_END		2
+
+// Zustnde der Ablaufsteuerung in der Timer1- bzw. USART-ISR
+enum ONE_WIRE_PHASE
+{
+	ONE_WIRE_PH_IDLE,			/*!< Timer steht */
+	ONE_WIRE_PH_START,			/*!< nchste Transaktion beginnen */
+	ONE_WIRE_PH_RESET_REL,		/*!< Reset-Puls beenden */
+	ONE_WIRE_PH_RESET_SMP,		/*!< Presence-Pulse abtasten, USART: Reset-Zeichen unterwegs */
+	ONE_WIRE_PH_SLOT,			/*!< nchsten Zeitschlitz beginnen */
+	ONE_WIRE_PH_WRITE0_REL,		/*!< 0-Bit beenden */
+};
+
+struct oneWire_engine_s
+{
+	struct oneWire_job_s	*queue[ONE_WIRE_QUEUE_NO];	/*!< Warteschlange */
+
+	volatile uint8_t	head;		/*!< aktuelle Transaktion, wird von der ISR weitergeschaltet */
+	volatile uint8_t	tail;		/*!< nchster freier Platz */
+	uint8_t				finished;	/*!< nchste abzuschlieende Transaktion */
+
+	// ab hier nur in der ISR benutzt
+	volatile uint8_t	phase;		/*!< ONE_WIRE_PHASE */
+	struct oneWire_job_s	*job;	/*!< aktuelle Transaktion */
+	uint8_t		index;		/*!< Byte-Nummer, erst schreiben, dann lesen */
+	uint8_t		mask;		/*!< Bitmaske im aktuellen Byte, LSB first */
+	uint8_t		byte;		/*!< aktuell gelesenes Byte */
+	uint8_t		crc8;		/*!< CRC8 der gelesenen Bytes */
+
+} oneWire_eng;
+#endif	// ONE_WIRE_ASYNC
+
+// Ablauf der Temperaturerfassung
+enum TEMP_STATE
+{
+	TEMP_ST_IDLE,		/*!< nchste Konvertierung starten */
+	TEMP_ST_CONV,		/*!< Konvertierung luft */
+	TEMP_ST_POWER,		/*!< Konvertierung mit starkem Pull-Up, feste Wartezeit */
+	TEMP_ST_POLL,		/*!< Abfrage, ob die Konvertierung fertig ist */
+	TEMP_ST_READ,		/*!< Scratchpad lesen */
+	TEMP_ST_SCAN,		/*!< Hintergrundsuche belegt den Bus */
+	TEMP_ST_ALARM,		/*!< Alarmsuche nach der Konvertierung */
+	TEMP_ST_COPY,		/*!< Scratchpad wird ins EEPROM des Sensors kopiert */
+	TEMP_ST_SETUP,		/*!< Transaktionskette an einem Sensor, endet mit TEMP_ST_IDLE */
+};
+
 struct oneWire_s
 {
 	uint8_t		dev_count;		/*!< Auswahl des ID-Speichers */
 
 	uint8_t		last_device;	/*!< 1 wenn letztes Gert gesucht wurde */
 	uint8_t		last_disc;		/*!< Bitposition des letzten Unterschiedes */
-//	uint8_t		last_fam_disc;	/*!< Unterschied im Family-Byte */
+	uint8_t		last_fam_disc;	/*!< Unterschied im Family-Byte */
 	uint8_t		crc8;			/*!< CRC8 der ID */
 
+	uint8_t		srch_cmd;		/*!< SRCH_ROM oder ALRM_SRCH */
+	uint8_t		srch_rom[8];	/*!< ID der laufenden Suche */
+	uint8_t		srch_bit;		/*!< nchste Bitposition 1 bis 64, 0 = Reset und Suchkommando */
+	uint8_t		srch_zero;		/*!< letzte 0-Entscheidung in diesem Durchlauf */
+	uint16_t	srch_slots;		/*!< Zeitschlitze der laufenden Suche */
+
 	uint8_t		rom[ONE_WIRE_DEV_NO][8];	/*!< ID-Speicher */
 
 	struct ds18b20_data
@@ -635,7 +1356,101 @@ struct oneWire_s
 		uint8_t	crc;			/*!< Prfsumme ber 8 Bytes */
 	} data;						/*!< Zwischenspeicher fr Daten */
 
+	uint8_t		dev;			/*!< gerade gelesener Sensor */
+	uint8_t		cmd[13];		/*!< MATCH_ROM, ID, Kommando, Daten fr WR_SCRATCH */
+
+	uint8_t		state;			/*!< TEMP_STATE */
+	uint8_t		conv_cnt;		/*!< Erfassungen seit CONVERT_T */
+	uint8_t		poll;			/*!< Lese-Zeitschlitze nach CONVERT_T, ungleich 0 wenn fertig */
+	uint8_t		conv_time;		/*!< gemessene Dauer der letzten Konvertierung in Erfassungen, siehe TEMP_CONV_TICK_MS */
+	uint8_t		parasite;		/*!< parasitr versorgte Sensoren, 1 Bit pro Sensor */
+	uint8_t		spu_ticks;		/*!< Dauer des starken Pull-Ups in Erfassungen */
+#if TEMP_SENSOR_CAL
+	uint8_t		cal_req;		/*!< Kalibrierung in den Sensor schreiben, 1 Bit pro Sensor */
+#endif
+	uint8_t		read_mask;		/*!< in dieser Runde zu lesende Sensoren, 1 Bit pro Sensor */
+	uint8_t		read_full;		/*!< nchsten Sensor komplett mit CRC lesen */
+	uint8_t		fast_cnt;		/*!< Runden seit dem letzten kompletten Lesen, 0 = diese Runde komplett */
+	uint16_t	read_time;		/*!< Busbelegung der laufenden Runde in 10us */
+	uint16_t	read_last[2];	/*!< Busbelegung der letzten kurzen [0] und kompletten [1] Runde in 10us */
+	uint8_t		alarm_cnt;		/*!< Runden bis zum nchsten Lesen aller Sensoren */
+
+	uint8_t		scan_cnt;		/*!< Sekunden seit der letzten Hintergrundsuche */
+	uint8_t		scan_req;		/*!< Hintergrundsuche nach der aktuellen Runde starten */
+	uint8_t		scan_seen;		/*!< gefundene bekannte Sensoren, 1 Bit pro Sensor */
+	uint8_t		scan_new;		/*!< neue Sensoren, hinter dev_count zwischengespeichert, bei voller Tabelle einer in cmd */
+	uint8_t		scan_lost;		/*!< bei der letzten Suche nicht mehr gefundene Sensoren, Diagnoseseite */
+	uint8_t		setup_req;		/*!< neue Sensoren vor der nchsten Runde einrichten, 1 Bit pro Sensor */
+	uint16_t	scan_slots;		/*!< Zeitschlitze der letzten vollstndigen Suche */
+
+	uint8_t		conv_err;		/*!< Konvertierungs-Timeouts, fr alle Sensoren gemeinsam, bleibt bei 255 stehen */
+	uint8_t		retry;			/*!< Wiederholungen beim gerade gelesenen Sensor */
+
+	// Zustand pro Sensor, die Zhler bleiben bei 15 stehen
+	struct temp_sens_s
+	{
+		uint8_t	err;			/*!< Lesefehler, TEMP_ERR_CRC und TEMP_ERR_PRES */
+		uint8_t	health;			/*!< TEMP_HEALTH_PEN und TEMP_HEALTH_HOLD */
+#if TEMP_SENSOR_CAL
+		uint8_t	cal_th;			/*!< Kennung, Verstrkung und Rolle, siehe TEMP_SENSOR_CAL */
+		uint8_t	cal_tl;			/*!< Offset in 1/16 C, vorzeichenbehaftet */
+#endif
+	} sens[ONE_WIRE_DEV_NO];
+
+	struct oneWire_job_s	job_read;	/*!< Scratchpad eines Sensors lesen */
+	struct oneWire_job_s	job_conv;	/*!< Konvertierung an allen Sensoren starten */
+
 } oneWire;
+
+#if CRC_1WIRE_MODE == 2
+// CRC8 mit Polynom x^8 + x^5 + x^4 + 1 in der blichen gespiegelten Form (0x8C)
+const uint8_t crc_1wire_tab[256] PROGMEM =
+{
+	0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83,
+	0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+	0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E,
+	0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+	0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0,
+	0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+	0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D,
+	0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+	0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5,
+	0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+	0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58,
+	0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+	0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6,
+	0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+	0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B,
+	0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+	0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F,
+	0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+	0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92,
+	0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+	0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C,
+	0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+	0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1,
+	0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+	0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49,
+	0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+	0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4,
+	0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+	0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A,
+	0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+	0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7,
+	0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35,
+};
+#elif CRC_1WIRE_MODE == 1
+// Tabellen fr das untere und obere Nibble: CRC(x) = tab_lo[x & 0x0F] ^ tab_hi[x >> 4]
+const uint8_t crc_1wire_tab_lo[16] PROGMEM =
+{
+	0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41
+};
+
+const uint8_t crc_1wire_tab_hi[16] PROGMEM =
+{
+	0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8, 0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
+#endif
 #endif
 
 struct output_data
@@ -653,8 +1468,14 @@ struct output_data
 
 /*---------------------------Unterprogramm-Deklarationen---------------------*/
 static void periph_init(void); // Peripherie initialisieren
+static void adc_setPlan (uint8_t off);
+static uint8_t adc_next (void);
+#if ADC_NOISE_SLEEP
+static void adc_sleepConv (void);
+#endif
 
 
+static void dspl_dec3 (uint8_t *mem, uint16_t value);
 static void dspl_uint8 (uint8_t pos, uint8_t dp, uint8_t value)		__attribute__((__unused__));
 static void dspl_hex_uint8 (uint8_t pos, uint8_t value);
 static void dspl_int8 (uint8_t pos, uint8_t dp, int8_t value);
@@ -663,8 +1484,31 @@ static void dspl_hex_uint16 (uint8_t pos, uint16_t value)			__attribute__((__unu
 static void dspl_text (uint8_t pos, uint8_t txtId);
 
 static void dspl_mem2seg (uint8_t pos);
+static void dspl_blank (uint8_t rows);
+#if !DSPL_MAX7219
+static void dspl_commit (void);
+#endif
+#if DSPL_MAX7219
+static void dspl_spiInit (void);
+static void dspl_spiWrite (uint8_t addr, uint8_t data);
+static void dspl_flush (void);
+#endif
+#if DSPL_OFF_S > 0
+static void dspl_off (void);
+static void dspl_on (void);
+#endif
+#if DSPL_DIM
+static void dspl_setBright (uint8_t mask, uint8_t level);
+static void dspl_updBright (void);
+#endif
 
 static void menu_readKey (uint8_t key);
+static void menu_loadKeys (void);
+static uint8_t menu_decodeKey (uint8_t key);
+#if MENU_KEY_CAL
+static void menu_calKey (uint8_t key);
+static void menu_calEnd (uint8_t slots);
+#endif
 static void menu_printMenu (void);
 
 static int8_t menu_incr (int8_t val, int8_t cmp, int8_t max);
@@ -674,14 +1518,68 @@ static void menu_loadConfig (void);
 static void menu_saveConfig (void);
 
 static void temp_startTemp (void);
-static void temp_readTemp (void);
+static void temp_task (void);
 static uint8_t temp_incrSeconds (void);
 static void temp_updCurMinMax (void);
+static temp_hist_t temp_histVal (temp_val_t value);
 static void temp_updHistMinMax (void);
 
 static void temp_updOutput (void);
+static void temp_evaluate (void);
+static void temp_updRoles (void);
+#if TEMP_KTY_CH || !ONE_WIRE_ENABLE
+static temp_val_t temp_ktyConv (uint16_t adc);
+#endif
+#if TEMP_KTY_CH
+static void temp_ktyTask (void);
+#endif
+
+#if ONE_WIRE_ENABLE
+static void temp_storeTemp (uint8_t i);
+static temp_val_t temp_convert (uint8_t i);
+#if TEMP_FAST_READ
+static uint8_t temp_checkFast (uint8_t i);
+#endif
+static uint8_t temp_addrDev (void);
+static void temp_submit (struct oneWire_job_s *job);
+static void temp_readDev (void);
+static void temp_readDone (struct oneWire_job_s *job);
+static void temp_pollDone (struct oneWire_job_s *job);
+static void temp_convDone (void);
+static void temp_writeDone (struct oneWire_job_s *job);
+static void temp_nextDev (void);
+static void temp_countErr (uint8_t *cnt, uint8_t mask);
+static void temp_tickHealth (void);
+#if TEMP_CONV_SINGLE == 0
+static void temp_readFrom (uint8_t i);
+#endif
+#if TEMP_BOOT_FAST || TEMP_SENSOR_CAL
+static void temp_bootConfig (uint8_t dev);
+#endif
+#if TEMP_SENSOR_CAL
+static void temp_loadCal (uint8_t dev, uint8_t valid);
+static void temp_writeCal (uint8_t dev);
+static void temp_copyStart (struct oneWire_job_s *job);
+static void temp_copyDone (void);
+static void temp_recallDone (struct oneWire_job_s *job);
+static void temp_adjCal (uint8_t dev, int8_t step);
+#endif
+static void temp_checkSupply (uint8_t dev);
+static void temp_cmdDev (uint8_t cmd, uint8_t flags, uint8_t rd_count, void (*done)(struct oneWire_job_s *job));
+static void temp_setupDev (uint8_t dev);
+static void temp_supplyDone (struct oneWire_job_s *job);
+#if TEMP_SENSOR_CAL
+static void temp_calDone (struct oneWire_job_s *job);
+#endif
+static void temp_scanStart (void);
+static void temp_scanStep (void);
+static void temp_scanEnd (void);
+#endif
 
 #if ONE_WIRE_ENABLE
+#if ONE_WIRE_USART
+static uint8_t oneWire_usartSlot (uint8_t data);
+#endif
 static uint8_t oneWire_reset (void);
 
 void oneWire_writeBit (uint8_t data);
@@ -693,10 +1591,38 @@ uint8_t oneWire_readByte (void);
 static uint8_t oneWire_findFirst (void);
 static uint8_t oneWire_findNext (void);
 static uint8_t oneWire_search (void);
+static void oneWire_srchInit (uint8_t cmd);
+static uint8_t oneWire_srchStep (uint8_t bits);
 
 uint8_t oneWire_selectDev (uint8_t dev);
+static uint8_t oneWire_readScratch (uint8_t dev);
+
+static uint8_t oneWire_loadRom (void);
+static void oneWire_saveRom (void);
 
 void oneWire_updateCRC (uint8_t byte);
+static uint8_t oneWire_crc8 (uint8_t crc, uint8_t byte);
+
+uint8_t oneWire_submit (struct oneWire_job_s *job);
+uint8_t oneWire_busy (void);
+void oneWire_poll (void);
+
+#if ONE_WIRE_ASYNC
+static uint8_t oneWire_jobInit (void);
+static uint8_t oneWire_jobBit (void);
+static void oneWire_jobSample (uint8_t bit);
+static uint8_t oneWire_jobEnd (uint8_t status);
+
+#if ONE_WIRE_USART
+static void oneWire_hwStart (void);
+static void oneWire_hwSlot (void);
+static void oneWire_hwEnd (uint8_t status);
+#else
+static uint16_t oneWire_hwStart (void);
+static uint16_t oneWire_hwSlot (void);
+static uint16_t oneWire_hwEnd (uint8_t status);
+#endif
+#endif
 
 #endif
 
@@ -709,8 +1635,8 @@ int main(void)
 	// alle Peripherie initialisieren
 	periph_init ();
 
-	// 1s Pause
-	for (m = 0; m < 100; m++)
+	// 100ms Pause, bis die Versorgung stabil ist
+	for (m = 0; m < 10; m++)
 		_delay_ms (10);
 
 
@@ -719,24 +1645,34 @@ int main(void)
 	dspl_text (1, TEXT_ID_BLANK);
 
 	// LED-Ausgnge ein
+#if DSPL_MAX7219
+	DDRB = MAX7219_LOAD | _BV(PB3) | _BV(PB5);
+	dspl_spiInit ();
+#else
 	DDRB = 0xFF;
 	DDRD = 0xFF;
+#endif
 
 
 	// Parameter laden
 	menu_loadConfig ();
 
+#if DSPL_DIM
+	// gespeicherte Helligkeit, automatisch startet mit voller Helligkeit
+	dspl_updBright ();
+#endif
+
 	// Men initialisieren
 	menu_cfg.menu = MENU_TEMP_VALUE;
 	menu_cfg.key = 0xFF;
-	menu_cfg.changed = 1;
+	menu_cfg.changed |= MENU_CHG_FULL;
 
 	// Spitzenwerte initialisieren
-	for (uint8_t i = 0; i < 2; i++) {
+	for (uint8_t i = 0; i < TEMP_HIST_CH_NO; i++) {
 	//	for (uint8_t j = 0; j < 24; j++) {
 		// Spitzenwertarray aktualisieren
-			temp_hist.min_array[i][0] = TEMP_VAL_MAX;
-			temp_hist.max_array[i][0] = TEMP_VAL_MIN;
+			temp_hist.min_array[i][0] = TEMP_HIST_MAX;
+			temp_hist.max_array[i][0] = TEMP_HIST_MIN;
 	//	}
 #if 0
 		// Spitzenwerte der letzten 6, 12 und 24 Stunden
@@ -751,27 +1687,53 @@ int main(void)
 	// Interrupte ein
 	sei();
 
+#if !DSPL_MAX7219
 	// Display-Timer starten
 	TIMER2_START;
+#endif
 
 #if ONE_WIRE_ENABLE
-	// ersten Sensor suchen
-	if (oneWire_findFirst() != 0) {
-		// weitere Sensoren suchen
-		while (oneWire_findNext() != 0) {
-			// die Gerteanzahl wird intern inkrementiert
+	// gespeicherte IDs prfen, nur wenn das fehlschlgt den ganzen Bus absuchen
+	if (oneWire_loadRom() == 0) {
+		// ersten Sensor suchen
+		if (oneWire_findFirst() != 0) {
+			// weitere Sensoren suchen
+			while (oneWire_findNext() != 0) {
+				// die Gerteanzahl wird intern inkrementiert
+			}
+		} else {
+			// nichts gefunden
+		}
+
+		// fr den nchsten Start merken
+		oneWire_saveRom ();
+	}
+
+	// READ POWER SUPPLY an alle: nur wenn ein Sensor parasitr versorgt ist, antwortet er mit 0
+	if (oneWire_reset () != 0) {
+		oneWire_writeByte (ONE_WIRE_CMD_SKIP_ROM);
+		oneWire_writeByte (ONE_WIRE_RD_SUPPLY);
+
+		if (oneWire_readBit () == 0) {
+			// dann jeden einzeln fragen
+			for (m = 0; m < oneWire.dev_count; m++)
+				temp_checkSupply (m);
 		}
-	} else {
-		// nichts gefunden
 	}
 
-	// gefundene Anzahl kurz anzeigen
+#if TEMP_BOOT_FAST || TEMP_SENSOR_CAL
+	// Kalibrierung bernehmen, erste Konvertierung mit reduzierter Auflsung
+	for (m = 0; m < oneWire.dev_count; m++)
+		temp_bootConfig (m);
+#endif
+
+	// Anzeigekanle den gefundenen Sensoren zuordnen
+	temp_updRoles ();
+
+	// gefundene Anzahl anzeigen, bleibt bis zur ersten Aktualisierung im Sekundentakt stehen
 	dspl_text (0, TEXT_ID_ON_WIRE);
 	dspl_hex_uint8 (1, oneWire.dev_count);
-
-	// 2s Pause
-	for (m = 0; m < 200; m++)
-		_delay_ms (10);
+	menu_cfg.changed = 0;
 
 #if 0
 	for (uint8_t dev = 0; dev < oneWire.dev_count; dev++) {
@@ -787,34 +1749,95 @@ int main(void)
 	}
 #endif
 
-#if ONE_WIRE_ENABLE
 	if (oneWire.dev_count > 0) {
-		// erste Temperaturerfassung starten
+		// erste Temperaturerfassung sofort starten, temp_task wartet auf das Ende
 		temp_startTemp ();
 	}
 
-	// 1s Pause, damit die Erfassung fertig ist
-	for (m = 0; m < 100; m++)
-		_delay_ms (10);
-#endif
-
 #endif	// ONE_WIRE_ENABLE
 
 	// ADC-Timer starten
 	TIMER0_START;
 
+#if MENU_KEY_CAL
+	// beim Einschalten gedrckte Taste: Tastentabelle neu einlernen, erst nach dem Loslassen
+	while (adc_data.key_new == 0)
+		;
+	if (adc_data.mem[ADC_KEY_SRC - ADMUX_MIN] < ADC_KEY_IDLE) {
+		menu_cfg.kcal = 1;
+		menu_cfg.keyCnt = MENU_KEY_CAL_SKIP;
+		menu_cfg.flash_rows = 0;
+		dspl_blank (0);
+	}
+#endif
+
+	// Tastentabelle whlen: eingelernt im EEPROM oder menu_key_tab im Flash
+	menu_loadKeys ();
+
 	while (1) {
 
-		// warten auf die Erfassung
-		if (adc_data.complete != 0) {
-			adc_data.complete = 0;
+#if MAIN_LOOP_PROBE
+		// jeder Durchlauf toggelt PC0
+		PINC = _BV(PC0);
+#endif
+
+#if ADC_NOISE_SLEEP
+		// von der Timer0-ISR eingestellte Wandlung im Schlaf starten
+		if (adc_data.sleep != 0)
+			adc_sleepConv ();
+#endif
+
+#if ONE_WIRE_ENABLE
+		// beendete 1-Wire-Transaktionen auswerten
+		oneWire_poll ();
+
+#if ONE_WIRE_SCAN_S > 0 || TEMP_ALARM_MODE
+		// Hintergrund- oder Alarmsuche, ein paar Bits pro Durchlauf und nur ohne laufende Transaktion
+		if ((oneWire.state == TEMP_ST_SCAN || oneWire.state == TEMP_ST_ALARM) && oneWire_busy() == 0)
+			temp_scanStep ();
+#endif
+#endif
+
+		// Tastenkanal, bei eingeschalteter Anzeige mit jedem Trigger (4ms)
+		if (adc_data.key_new != 0) {
+			adc_data.key_new = 0;
 
 			// Taste kopieren, nur 8Bit fr schnelleren Vergleich
-			key = adc_data.mem[2] >> 2;
+			key = adc_data.mem[ADC_KEY_SRC - ADMUX_MIN] >> 2;
+
+			// Rauschen des Tastenkanals fr die Diagnose
+			if (menu_cfg.key_min > adc_data.mem[ADC_KEY_SRC - ADMUX_MIN])
+				menu_cfg.key_min = adc_data.mem[ADC_KEY_SRC - ADMUX_MIN];
+			if (menu_cfg.key_max < adc_data.mem[ADC_KEY_SRC - ADMUX_MIN])
+				menu_cfg.key_max = adc_data.mem[ADC_KEY_SRC - ADMUX_MIN];
 		//	dspl_hex_uint16 (1, adc_data.mem[2]);
 
+			// Tastendruckerkennung
+			menu_readKey (key);
+
+			// Men prfen und anzeigen
+			menu_printMenu ();
+
+#if DSPL_MAX7219
+			// genderte Stellen bertragen
+			dspl_flush ();
+#else
+			// fertiges Bild freigeben
+			dspl_commit ();
+#endif
+		}
+
+		// warten auf die Erfassung
+		if (adc_data.complete != 0) {
+			adc_data.complete = 0;
+
 #if ONE_WIRE_ENABLE
-			// ab sofort vom DS18B20
+			// ab sofort vom DS18B20, die Erfassung luft unabhngig vom Sekundentakt
+			temp_task ();
+#if TEMP_KTY_CH
+			// KTY-Kanle mit jeder Erfassung
+			temp_ktyTask ();
+#endif
 #else
 			// Ergebnisse anzeigen, 10Bit gehen auf alle Flle
 #if TEMP_AVERAGE_NO > 0
@@ -829,8 +1852,8 @@ int main(void)
 				temp_data.avg[i] = temp_data.sum[i] / (TEMP_AVERAGE_NO / 4);
 			//	temp_data.avg[i] = temp_data.sum[i] / 2;
 
-				// erstmal Genauigkeit wegwerfen
-				temp_hist.value[i] = temp_data.avg[i] >> 2;
+				// Kennlinie, der Mittelwert hat 12 Bit
+				temp_hist.value[i] = temp_ktyConv ((temp_data.avg[i] << TEMP_KTY_OVS_BITS) >> 2);
 			}
 			// Index dekrementieren
 			if (temp_data.index > 0)
@@ -879,42 +1902,57 @@ int main(void)
 				// zurcksetzen
 				temp_hist.cnt = 0;
 
+#if DSPL_DIM && DSPL_LDR
+				// Fotowiderstand mit ca. 8s Zeitkonstante filtern, kurze Schatten lassen die Anzeige in Ruhe,
+				// der erste Messwert wird direkt bernommen
+				if (dspl.ldr == 0)
+					dspl.ldr = adc_data.mem[3] << 6;
+				else
+					dspl.ldr = dspl.ldr - (dspl.ldr >> 3) + (adc_data.mem[3] << 3);
+				if (temp_cfg.para[CFG_PARA_BRIGHT] == 0)
+					dspl_updBright ();
+#endif
+
+				// Rauschen der letzten Sekunde, groe Sprnge sind Tastenwechsel
+				if (menu_cfg.key_max >= menu_cfg.key_min)
+					menu_cfg.key_pp = (menu_cfg.key_max - menu_cfg.key_min > 0xFF) ? 0xFF : menu_cfg.key_max - menu_cfg.key_min;
+				menu_cfg.key_min = 0xFFFF;
+				menu_cfg.key_max = 0;
+
+#if DSPL_OFF_S > 0
+				// Anzeige nach lngerer Zeit ohne Tastendruck abschalten
+				if (dspl.off == 0 && ++menu_cfg.idle >= DSPL_OFF_S)
+					dspl_off ();
+#endif
+
 				if (    menu_cfg.menu == MENU_TEMP_VALUE
+					|| menu_cfg.menu == MENU_TEMP_SENSOR
+					|| menu_cfg.menu == MENU_TEMP_DIAG
 #if 0
 					|| (menu_cfg.menu >= MENU_SELECT_HOURS && menu_cfg.menu <= MENU_SELECT_SECONDS)
 #endif
 				) {
 					// aktuelle Messwerte zyklisch aktualisieren
-					menu_cfg.changed = 1;
+					menu_cfg.changed |= MENU_CHG_VALUE;
 				}
 
 #if ONE_WIRE_ENABLE
 				if (oneWire.dev_count > 0) {
-					// Temperaturen im Sekundentakt lesen (die Konvertierungszeit betrgt max 750ms)
-					temp_readTemp ();
-
-					// nchste Erfassung starten, Befehl gleich an alle Sensoren senden
-					temp_startTemp ();
-
-					// Spitzenwerte aktualisieren
-					temp_updCurMinMax ();
-#endif
-
-					// Sekunden inkrementieren, liefert 1 wenn eine Stunde voll ist
-					if (temp_incrSeconds() != 0) {
-						// MinMax-Werte der letzten Stunden aktualisieren
-						temp_updHistMinMax ();
-					}
+					// die jeweils neuesten Messwerte im Sekundentakt auswerten
+					temp_evaluate ();
+					temp_tickHealth ();
+				}
 
-					// Messwerte ausgeben, wenn nicht gerade beim Einstellen
-					if (   menu_cfg.menu < MENU_EDIT_CH1_ON
-						|| menu_cfg.menu > MENU_EDIT_CH2_OFF)
-					{
-						// Werte vergleichen, Ausgnge schalten
-						temp_updOutput ();
-					}
-#if ONE_WIRE_ENABLE
+#if ONE_WIRE_SCAN_S > 0
+				// neue oder verschwundene Sensoren suchen, startet nach der laufenden Runde
+				if (++oneWire.scan_cnt >= ONE_WIRE_SCAN_S) {
+					oneWire.scan_cnt = 0;
+					oneWire.scan_req = 1;
 				}
+#endif
+#else
+				// Messwerte auswerten
+				temp_evaluate ();
 #endif
 			}
 
@@ -928,28 +1966,64 @@ int main(void)
 
 				// Blinken beim Einstellen oder wenn aktuelle Werte ungltig sind
 				if (menu_cfg.menu == MENU_TEMP_VALUE
+					|| menu_cfg.menu == MENU_TEMP_SENSOR
 					|| (menu_cfg.menu >= MENU_EDIT_CH1_ON
-						&& menu_cfg.menu <= MENU_EDIT_CH2_OFF))
+						&& menu_cfg.menu <= MENU_EDIT_LAST))
 				{
 					// toggeln
 					menu_cfg.flash ^= 1;
 					// aktualisieren
-					menu_cfg.changed = 1;
+					menu_cfg.changed |= MENU_CHG_FLASH;
 				} else {
 					// nicht mehr blinken
 					if (menu_cfg.flash != 0) {
 						menu_cfg.flash = 0;
-						menu_cfg.changed = 1;
+						menu_cfg.changed |= MENU_CHG_FLASH;
 					}
 				}
 			}
 
-			// Tastendruckerkennung
-			menu_readKey (key);
-
 			// Men prfen und anzeigen
 			menu_printMenu ();
+
+#if DSPL_MAX7219
+			// genderte Stellen bertragen
+			dspl_flush ();
+#else
+			// fertiges Bild freigeben
+			dspl_commit ();
+#endif
+		}
+
+#if DSPL_OFF_S > 0
+		// Anzeige aus: bis zum nchsten Interrupt schlafen, die Hintergrundsuche braucht
+		// aber jeden Durchlauf; Interrupte erst mit sleep_cpu freigeben, sonst geht
+		// ein gerade gesetztes complete-Flag bis zum nchsten Interrupt verloren
+		if (dspl.off != 0
+#if ONE_WIRE_ENABLE && (ONE_WIRE_SCAN_S > 0 || TEMP_ALARM_MODE)
+			&& oneWire.state != TEMP_ST_SCAN && oneWire.state != TEMP_ST_ALARM
+#endif
+		) {
+			cli ();
+			if (adc_data.complete == 0 && adc_data.key_new == 0
+#if ADC_NOISE_SLEEP
+				&& adc_data.sleep == 0
+#endif
+			) {
+#if SLEEP_PROBE
+				PORTC &= ~_BV(PC0);
+#endif
+				sleep_enable ();
+				sei ();
+				sleep_cpu ();
+				sleep_disable ();
+#if SLEEP_PROBE
+				PORTC |= _BV(PC0);
+#endif
+			}
+			sei ();
 		}
+#endif
 	}
 
 	return 0;
@@ -980,7 +2054,20 @@ void periph_init(void) //Timer0 initialisieren
 //	OCR1AH = 0x7A;
 //	OCR1AL = 0x12;
 //	TIMSK1 = _BV(OCIE1A);
+#if ONE_WIRE_ENABLE && ONE_WIRE_USART
+	// 1-Wire ber USART0: 8N1, doppelte Geschwindigkeit fr genauere Bitraten
+	UCSR0A = _BV(U2X0);
+	UBRR0 = ONE_WIRE_UBRR_SLOT;
+	UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+	UCSR0B = _BV(RXEN0) | _BV(TXEN0);
+#elif ONE_WIRE_ENABLE && ONE_WIRE_ASYNC
+	// 1-Wire-Zeitschlitze: OCR1A wird in der ISR jeweils neu gesetzt
+	TCCR1A = 0;
+	TCCR1B = _BV(WGM12);
+	TIMSK1 = _BV(OCIE1A);
+#endif
 
+#if !DSPL_MAX7219
 	/*	Timer luft im CTC-Mode -> WGM02:0 = 010, die Output Compare Ausgnge
 		werden nicht benutzt -> COM0A1:0 = 00, COM0B1:0 = 00, als Clock
 		erstmal nix, der Timer soll noch nicht loslaufen -> CS02:0 = 000*/
@@ -988,29 +2075,65 @@ void periph_init(void) //Timer0 initialisieren
 //	TCCR2B = 0;
 //	TCNT2 = 0;
 	OCR2A = TIMER2_OCRA;
+#if DSPL_DIM
+	// Compare B schaltet die Stelle vorzeitig ab, bis zum Laden der Parameter volle Helligkeit
+	OCR2B = 0xFF;
+	TIMSK2 = _BV(OCIE2A) | _BV(OCIE2B);
+#else
 	TIMSK2 = _BV(OCIE2A);
+#endif
+
+	// Ziffernauswahl (Active Low) fr die Multiplex-ISR vorberechnen
+	for (uint8_t i = 0; i < DIGIT_NO; i++) {
+		dspl.port[i][1] = ~_BV(i);
+#if DSPL_DIM
+		dspl.port[i][2] = 0xFF;
+#endif
+	}
+	dspl.ptr = &dspl.port[0][0];
+#endif
 
 	/* ADC */
-	adc_data.source = ADMUX_MIN;
-	ADMUX = ADMUX_MIN | ADMUX_REFSEL;
+	adc_setPlan (0);
+	ADMUX = ADC_KEY_SRC | ADMUX_REFSEL;
+#if ADC_TIMER_TRIG
 	// ADC Trigger Source: Timer0 Compare Match A
 	ADCSRB = _BV(ADTS1) | _BV(ADTS0);
 	// ADC ein und Prescaler auf 64, Interrupt ein, Auto Trigger enable
-	ADCSRA = _BV(ADEN) | _BV(ADIE) | _BV(ADATE) | _BV(ADPS2) | _BV(ADPS1);
+	ADCSRA = ADC_CSRA | _BV(ADATE);
+#else
+	// bleibt aus, gestartet wird in der Timer0-ISR
+	ADCSRB = 0;
+	ADCSRA = 0;
+#endif
 
 	/* Power Reduction Register */
 	PRR = 0
-	//	| _BV(PRADC)	// ADC aus
+#if !ADC_TIMER_TRIG
+		| _BV(PRADC)	// ADC aus
+#endif
+#if !(ONE_WIRE_ENABLE && ONE_WIRE_USART)
 		| _BV(PRUSART0)	// UART aus
+#endif
+#if !DSPL_MAX7219
 		| _BV(PRSPI)	// SPI aus
+#endif
 		| _BV(PRTWI)	// TWI aus
 	//	| _BV(PRTIM0)	// Timer0 aus
+#if !(ONE_WIRE_ENABLE && ONE_WIRE_ASYNC) || ONE_WIRE_USART
 		| _BV(PRTIM1)	// Timer1 aus
-	//	| _BV(PRTIM2)	// Timer2 aus
+#endif
+#if DSPL_MAX7219
+		| _BV(PRTIM2)	// Timer2 aus
+#endif
 		;
 
 	/* Digital I/O Disable Register */
+#if DSPL_DIM && DSPL_LDR
+	DIDR0 = _BV(ADC0D) | _BV(ADC1D) | _BV(ADC2D) | _BV(ADC3D);
+#else
 	DIDR0 = _BV(ADC0D) | _BV(ADC1D) | _BV(ADC2D);	// | _BV(ADC3D);
+#endif
 
 #if I2C_ENABLE
 	/* TWI */
@@ -1043,6 +2166,13 @@ void periph_init(void) //Timer0 initialisieren
 	IOReg = SPDR;
 #endif
 
+#if DSPL_MAX7219
+	/* SPI fr den MAX7219: Master, Mode 0, MSB zuerst, SCK = CK/2 = 4 MHz (max. 10 MHz);
+	   SS (LOAD) ist bis zum Setzen von DDRB Eingang mit Pull-Up, bleibt also Master */
+	SPCR = _BV(SPE) | _BV(MSTR);
+	SPSR = _BV(SPI2X);
+#endif
+
 	/* Pin Change Mask Registers */
 //	PCMSK0 = 0;		//_BV(PCINT0);
 //	PCMSK1 = 0;
@@ -1056,6 +2186,10 @@ void periph_init(void) //Timer0 initialisieren
 	// PortC: ADC, PC4: Relais1, PC5: Relais2 Active High
 	PORTC = 0;
 	DDRC = _BV(PC4) | _BV(PC5);
+#if MAIN_LOOP_PROBE || BOOT_TIME_PROBE || SLEEP_PROBE
+	// PC0 als Messausgang
+	DDRC |= _BV(PC0);
+#endif
 
 	// PortD: Segmentauswahl, Active High
 	PORTD = 0;
@@ -1063,6 +2197,95 @@ void periph_init(void) //Timer0 initialisieren
 
 	/* Schlafmodus einstellen: Powerdown */
 //	SMCR = _BV(SM1);
+	// Idle, die Timer und der ADC laufen weiter
+	set_sleep_mode (SLEEP_MODE_IDLE);
+}
+
+void adc_setPlan (uint8_t off)
+{
+	// Teiler byteweise, die ISR sieht keinen halben Plan; laufende Zhler bleiben stehen
+	for (uint8_t i = 0; i < ADC_SRC_NO; i++)
+		adc_data.div[i] = pgm_read_byte (&adc_div_tab[off][i]);
+}
+
+/*
+ * Wird einmal pro Trigger aus der ISR aufgerufen und liefert die als nchste
+ * zu wandelnde Quelle oder ADC_SRC_NONE. Alle Zhler laufen weiter, fllige
+ * Quellen warten, bis sie dran sind; der Tastenkanal kommt nur zum Zug, wenn
+ * keine andere Quelle fllig ist.
+ */
+uint8_t adc_next (void)
+{
+	uint8_t		i, next = ADC_SRC_NONE;
+
+	for (i = 0; i < ADC_SRC_NO; i++) {
+		if (adc_data.div[i] == 0)
+			continue;
+
+		if (adc_data.cnt[i] > 0)
+			adc_data.cnt[i]--;
+
+		if (adc_data.cnt[i] == 0 && next == ADC_SRC_NONE && i != ADC_KEY_SRC - ADMUX_MIN)
+			next = i;
+	}
+
+	if (next == ADC_SRC_NONE) {
+		if (adc_data.div[ADC_KEY_SRC - ADMUX_MIN] == 0 || adc_data.cnt[ADC_KEY_SRC - ADMUX_MIN] != 0)
+			return ADC_SRC_NONE;
+		next = ADC_KEY_SRC - ADMUX_MIN;
+	}
+
+	adc_data.cnt[next] = adc_data.div[next];
+	return next + ADMUX_MIN;
+}
+
+#if ADC_NOISE_SLEEP
+void adc_sleepConv (void)
+{
+	cli ();
+	if (adc_data.sleep == 0) {
+		// schon von der Timer0-ISR gestartet
+		sei ();
+		return;
+	}
+	adc_data.sleep = 0;
+
+#if ONE_WIRE_ENABLE && ONE_WIRE_ASYNC
+	if (oneWire_eng.phase != ONE_WIRE_PH_IDLE) {
+		// Timer1 bzw. USART stehen im Schlaf, die Zeitschlitze wrden gedehnt
+		ADCSRA |= _BV(ADSC);
+		sei ();
+		return;
+	}
+#endif
+
+	// CPU- und I/O-Takt anhalten, die Wandlung startet mit dem Einschlafen;
+	// sei wirkt erst nach sleep_cpu, geweckt wird von der ADC-ISR
+	set_sleep_mode (SLEEP_MODE_ADC);
+	sleep_enable ();
+	sei ();
+	sleep_cpu ();
+	sleep_disable ();
+	set_sleep_mode (SLEEP_MODE_IDLE);
+}
+#endif
+
+void dspl_dec3 (uint8_t *mem, uint16_t value)
+{
+	uint8_t	digit;
+
+	/*
+	 * 0...999 in drei Ziffern zerlegen, ohne Division (der ATmega hat keinen
+	 * Dividierer, % 10 und / 10 kosten je einen Aufruf von __udivmodhi4):
+	 * 41 / 4096 und 103 / 1024 sind fr 0...999 bzw. 0...99 exakt wie / 100 und / 10
+	 */
+	digit = ((uint16_t)value * 41) >> 12;
+	mem[0] = digit;
+	value -= digit * 100;
+
+	digit = ((uint8_t)value * 103) >> 10;
+	mem[1] = digit;
+	mem[2] = (uint8_t)value - digit * 10;
 }
 
 void dspl_uint8 (uint8_t pos, uint8_t dp, uint8_t value)
@@ -1075,9 +2298,7 @@ void dspl_uint8 (uint8_t pos, uint8_t dp, uint8_t value)
 		// ersten 4 Ziffern
 	}
 
-	dspl.mem[pos + 3] = value % 10;	value /= 10;
-	dspl.mem[pos + 2] = value % 10;	value /= 10;
-	dspl.mem[pos + 1] = value % 10;
+	dspl_dec3 (&dspl.mem[pos + 1], value);
 	dspl.mem[pos + 0] = DIGIT_0_;
 
 	switch (dp)
@@ -1156,10 +2377,12 @@ void dspl_int16 (uint8_t pos, uint8_t dp, int16_t value)
 	}
 
 	// erste Ziffer 0 oder 1
-	if (value >= 1000)
+	if (value >= 1000) {
 		first += DIGIT_P1;	// Minus/Plus 1
-	else
+		value -= 1000;
+	} else {
 		first += DIGIT_P0;	// Minus/Plus 0
+	}
 
 	// restliche Ziffern ermitteln
 	if (pos != 0) {
@@ -1169,9 +2392,7 @@ void dspl_int16 (uint8_t pos, uint8_t dp, int16_t value)
 		// ersten 4 Ziffern
 	}
 
-	dspl.mem[pos + 3] = value % 10;	value /= 10;
-	dspl.mem[pos + 2] = value % 10;	value /= 10;
-	dspl.mem[pos + 1] = value % 10;
+	dspl_dec3 (&dspl.mem[pos + 1], value);
 	dspl.mem[pos + 0] = first;
 
 	switch (dp)
@@ -1245,6 +2466,10 @@ void dspl_mem2seg (uint8_t pos)
 		// ersten 4 Ziffern
 	}
 
+	// ein noch nicht bernommenes Bild zurckhalten, solange hier geschrieben wird
+	dspl.swap = DSPL_SWAP_WRITE;
+	DSPL_BARRIER;
+
 	for (i = pos; i < (4 + pos); i++) {
 		// Ziffer holen
 		value = dspl.mem[i];
@@ -1264,35 +2489,332 @@ void dspl_mem2seg (uint8_t pos)
 	}
 }
 
-void menu_readKey (uint8_t key)
+#if DSPL_DIM
+void dspl_setBright (uint8_t mask, uint8_t level)
 {
-	if (key == 0xFF) {
-		// keine Taste gedrckt
+#if DSPL_MAX7219
+	// der MAX7219 kennt nur eine globale Helligkeit
+	(void)mask;
+	dspl_spiWrite (MAX7219_INTENSITY, pgm_read_byte(&dspl_dim_tab[level - 1]));
+#else
+	uint8_t		i, ocr;
 
-	} else if (key >= (uint8_t)(ADC_KEY_MENU_MIN >> 2)
-			&& key <= (uint8_t)(ADC_KEY_MENU_MAX >> 2))
-	{
-		key = MENU_KEY_MENU;
+	// Einschaltdauer der Stufe, gilt ab dem nchsten Zeitfenster der Stelle
+	ocr = pgm_read_byte(&dspl_dim_tab[level - 1]);
 
-	} else if (key >= (uint8_t)(ADC_KEY_UP_MIN >> 2)
-			&& key <= (uint8_t)(ADC_KEY_UP_MAX >> 2))
-	{
-		key = MENU_KEY_UP;
+	for (i = 0; i < DIGIT_NO; i++, mask >>= 1) {
+		if (mask & 0x01)
+			dspl.port[i][2] = ocr;
+	}
+#endif
+}
 
-	} else if (key >= (uint8_t)(ADC_KEY_DOWN_MIN >> 2)
-			&& key <= (uint8_t)(ADC_KEY_DOWN_MAX >> 2))
-	{
-		key = MENU_KEY_DOWN;
+void dspl_updBright (void)
+{
+	uint8_t		level;
 
-	} else if (key >= (uint8_t)(ADC_KEY_OK_MIN >> 2)
-			&& key <= (uint8_t)(ADC_KEY_OK_MAX >> 2))
-	{
-		key = MENU_KEY_OK;
+	level = temp_cfg.para[CFG_PARA_BRIGHT];
+#if DSPL_LDR
+	if (level == 0) {
+		// automatisch: hell -> kleiner Widerstand -> kleine Spannung -> hohe Stufe
+		level = DSPL_DIM_NO - (((dspl.ldr >> 8) * DSPL_DIM_NO) >> 8);
+	}
+#endif
+
+	// globale Helligkeit fr alle Stellen
+	dspl_setBright (0xFF, level);
+}
+#endif
+
+#if DSPL_OFF_S > 0
+void dspl_off (void)
+{
+	// ein offenes Einstellmen wie mit MENU verlassen, sonst ruht die Regelung
+	if (menu_cfg.menu >= MENU_EDIT_CH1_ON && menu_cfg.menu <= MENU_EDIT_LAST) {
+		menu_cfg.key = MENU_KEY_MENU;
+		menu_cfg.changed |= MENU_CHG_FULL;
+	}
+
+#if DSPL_MAX7219
+	// Treiber abschalten, die Register bleiben erhalten
+	dspl_spiWrite (MAX7219_SHUTDOWN, 0);
+#else
+	// Multiplex anhalten, alle Ziffern (Active Low) aus, Timer2 vom Takt trennen
+	TIMER2_STOP;
+	PORTB = 0xFF;
+	cli ();
+	PRR |= _BV(PRTIM2);	// die Timer0-ISR schaltet PRADC
+	sei ();
+#endif
+
+	// Tastenkanal seltener, nicht bentigte Quellen aus, der Erfassungstakt bleibt gleich
+	adc_setPlan (1);
+
+	dspl.off = 1;
+}
+
+void dspl_on (void)
+{
+	// alle Quellen wieder wandeln
+	adc_setPlan (0);
+
+#if DSPL_MAX7219
+	dspl_spiWrite (MAX7219_SHUTDOWN, 1);
+#else
+	// Multiplex luft an der alten Stelle weiter, die erste Ziffer kommt nach sptestens 1,6ms
+	cli ();
+	PRR &= ~_BV(PRTIM2);
+	sei ();
+	TIMER2_START;
+#endif
+
+	dspl.off = 0;
+}
+#endif
+
+#if DSPL_MAX7219
+void dspl_spiInit (void)
+{
+	uint8_t		i;
+
+	// Segmente direkt ansteuern, alle 8 Ziffern, kein Testmodus
+	dspl_spiWrite (MAX7219_TEST, 0);
+	dspl_spiWrite (MAX7219_DECODE, 0);
+	dspl_spiWrite (MAX7219_SCAN_LIMIT, DIGIT_NO - 1);
+	dspl_spiWrite (MAX7219_INTENSITY, 0x0F);
+
+	// nach dem Einschalten ist der Ziffernspeicher undefiniert
+	for (i = 0; i < DIGIT_NO; i++) {
+		dspl_spiWrite (MAX7219_DIGIT0 + i, 0);
+		dspl.sent[i] = 0;
+	}
+
+	dspl_spiWrite (MAX7219_SHUTDOWN, 1);
+}
+
+void dspl_spiWrite (uint8_t addr, uint8_t data)
+{
+	// 16 Bit, Adresse zuerst, mit der steigenden Flanke an LOAD bernehmen
+	PORTB &= ~MAX7219_LOAD;
+
+	SPDR = addr;
+	while ((SPSR & _BV(SPIF)) == 0)
+		;
+	SPDR = data;
+	while ((SPSR & _BV(SPIF)) == 0)
+		;
+
+	PORTB |= MAX7219_LOAD;
+}
+
+void dspl_flush (void)
+{
+	uint8_t		i, rows, seg, out, m, b;
+
+	if (dspl.swap == DSPL_SWAP_NONE)
+		return;
+	dspl.swap = DSPL_SWAP_NONE;
+
+	rows = dspl.blank;
+	for (i = 0; i < DIGIT_NO; i++) {
+		// zweite Zeile
+		if (i == DIGIT_NO / 2)
+			rows >>= 1;
+
+		// ausgeblendete Zeile: alle Segmente aus
+		seg = (rows & 0x01) ? 0 : dspl.seg[i];
+
+		// nur genderte Stellen bertragen, 2 x 8 Takte SCK pro Stelle
+		if (seg == dspl.sent[i])
+			continue;
+		dspl.sent[i] = seg;
+
+		// Segmente A bis G liegen beim MAX7219 auf D6 bis D0, DP bleibt auf D7
+		out = seg & SEGMENT_DP;
+		for (m = SEGMENT_A, b = 0x40; b != 0; m <<= 1, b >>= 1) {
+			if (seg & m)
+				out |= b;
+		}
+
+		dspl_spiWrite (MAX7219_DIGIT0 + i, out);
+	}
+}
+#endif
+
+void dspl_blank (uint8_t rows)
+{
+	// Zeilen beim bernehmen in der ISR ausblenden, der Segmentspeicher bleibt erhalten
+	if (dspl.blank != rows) {
+		dspl.swap = DSPL_SWAP_WRITE;
+		DSPL_BARRIER;
+		dspl.blank = rows;
+	}
+}
+
+#if !DSPL_MAX7219
+void dspl_commit (void)
+{
+	// einmal pro fertigem Bild: die ISR bernimmt beide Zeilen am Ende des laufenden Bildes
+	if (dspl.swap == DSPL_SWAP_WRITE) {
+		DSPL_BARRIER;
+		dspl.swap = DSPL_SWAP_READY;
+	}
+}
+#endif
+
+void menu_loadKeys (void)
+{
+	// eingelernte Tabelle nur, wenn das Einlernen abgeschlossen wurde
+	menu_cfg.keyEE = (eeprom_read_byte ((const void *)(MENU_KEY_EE_OFFSET)) == MENU_KEY_TAB_NO);
+}
+
+uint8_t menu_decodeKey (uint8_t key)
+{
+	struct menu_key_s	k;
+	uint8_t				i;
+
+	// Eintrge direkt aus EEPROM bzw. Flash, die Tabelle belegt kein RAM
+	for (i = 0; i < MENU_KEY_TAB_NO; i++) {
+		if (menu_cfg.keyEE)
+			eeprom_read_block (&k, (const void *)(MENU_KEY_EE_OFFSET + 1 + i * sizeof(k)), sizeof(k));
+		else
+			memcpy_P (&k, &menu_key_tab[i], sizeof(k));
+
+		if (k.tol != 0 && key >= k.center - k.tol && key <= k.center + k.tol)
+			return k.code;
+	}
+
+	// auerhalb der definierten Grenzen
+	return 0xFF;
+}
+
+#if MENU_KEY_CAL
+void menu_calKey (uint8_t key)
+{
+	struct menu_key_s	k, n;
+	uint8_t				slot, i, d;
+
+	slot = menu_cfg.kcal - 1;
+
+#if DSPL_OFF_S > 0
+	// beim Einlernen bleibt die Anzeige an
+	menu_cfg.idle = 0;
+#endif
+
+	// Rohwert anzeigen
+	if (menu_cfg.keyLast != key)
+		menu_cfg.changed |= MENU_CHG_VALUE;
+
+	if (key >= (uint8_t)(ADC_KEY_IDLE >> 2)) {
+		// losgelassen
+		if (menu_cfg.keyCnt == MENU_KEY_CAL_NEXT) {
+			if (++menu_cfg.kcal > MENU_KEY_TAB_NO)
+				menu_calEnd (MENU_KEY_TAB_NO);
+		} else if (menu_cfg.keyCnt == MENU_KEY_CAL_END) {
+			menu_calEnd (slot);
+		}
+		menu_cfg.keyCnt = 0;
+
+	} else if (menu_cfg.keyCnt >= MENU_KEY_CAL_NEXT) {
+		// wartet aufs Loslassen
 
 	} else {
-		// auerhalb der definierten Grenzen
-		key = 0xFF;
+		// Streuung seit dem ersten Wert mitfhren
+		if (menu_cfg.keyCnt == 0 || key < menu_cfg.kcalMin)
+			menu_cfg.kcalMin = key;
+		if (menu_cfg.keyCnt == 0 || key > menu_cfg.kcalMax)
+			menu_cfg.kcalMax = key;
+
+		if (menu_cfg.kcalMax - menu_cfg.kcalMin > MENU_KEY_CAL_SPREAD) {
+			// wackelt zu stark, ab diesem Wert neu zhlen
+			menu_cfg.kcalMin = key;
+			menu_cfg.kcalMax = key;
+			menu_cfg.keyCnt = 1;
+
+		} else if (++menu_cfg.keyCnt == MENU_KEY_CAL_NEXT) {
+			// ruhig genug, nach MENU_KEY_CAL_CNT Werten Mitte und halbe Streuung bernehmen
+			k.center = (menu_cfg.kcalMin + menu_cfg.kcalMax + 1) / 2;
+			k.tol = menu_cfg.kcalMax - k.center;
+
+			// schon eingelernte Taste: beendet das Einlernen, aber erst nach den vier Grundtasten
+			for (i = 0; i < slot; i++) {
+				eeprom_read_block (&n, (const void *)(MENU_KEY_EE_NEW + i * sizeof(n)), 2);
+				d = (k.center > n.center) ? k.center - n.center : n.center - k.center;
+				if (d <= n.tol + k.tol + MENU_KEY_CAL_MARGIN) {
+					menu_cfg.keyCnt = (slot >= 4) ? MENU_KEY_CAL_END : MENU_KEY_CAL_SKIP;
+					break;
+				}
+			}
+			if (i == slot)
+				eeprom_update_block (&k, (void *)(MENU_KEY_EE_NEW + slot * sizeof(k)), 2);
+		}
+	}
+
+	menu_cfg.keyLast = key;
+}
+
+void menu_calEnd (uint8_t slots)
+{
+	struct menu_key_s	k;
+	uint8_t				i, j, c, gap, tol;
+
+	// alte Tabelle erst jetzt ungltig: ein Abbruch beim Schreiben fllt auf die Standardtabelle zurck
+	eeprom_update_byte ((void *)(MENU_KEY_EE_OFFSET), 0xFF);
+
+	for (i = 0; i < MENU_KEY_TAB_NO; i++) {
+		// Mitte und halbe Streuung aus menu_calKey
+		eeprom_read_block (&k, (const void *)(MENU_KEY_EE_NEW + i * sizeof(k)), 2);
+		k.code = pgm_read_byte (&menu_key_tab[i].code);
+
+		// Streuung mit Zugabe, aber nicht enger als die Standardtabelle bzw. ADC_KEY_TOL fr die Zusatzpltze
+		tol = pgm_read_byte (&menu_key_tab[i].tol);
+		if (tol == 0)
+			tol = ADC_KEY_TOL >> 2;
+		if (k.tol + MENU_KEY_CAL_MARGIN > tol)
+			tol = k.tol + MENU_KEY_CAL_MARGIN;
+
+		// halber Abstand zur nchsten Taste bzw. zum Ruhewert, die Fenster berhren sich nicht
+		gap = (ADC_KEY_IDLE >> 2) - k.center;
+		for (j = 0; j < slots; j++) {
+			c = eeprom_read_byte ((const void *)(MENU_KEY_EE_NEW + j * sizeof(k)));
+			if (j != i && gap > ((c > k.center) ? c - k.center : k.center - c))
+				gap = (c > k.center) ? c - k.center : k.center - c;
+		}
+		k.tol = (gap - 1) / 2;
+		if (k.tol > tol)
+			k.tol = tol;
+
+		// nicht eingelernte Pltze bleiben frei
+		if (i >= slots)
+			k.tol = 0;
+
+		eeprom_update_block (&k, (void *)(MENU_KEY_EE_OFFSET + 1 + i * sizeof(k)), sizeof(k));
+	}
+
+	// komplett geschrieben, erst jetzt gltig
+	eeprom_update_byte ((void *)(MENU_KEY_EE_OFFSET), MENU_KEY_TAB_NO);
+	menu_loadKeys ();
+
+	// zurck in den normalen Betrieb, die Taste ist schon losgelassen
+	menu_cfg.kcal = 0;
+	menu_cfg.keyLast = 0xFF;
+	menu_cfg.changed |= MENU_CHG_FULL;
+}
+#endif
+
+void menu_readKey (uint8_t key)
+{
+#if MENU_KEY_CAL
+	if (menu_cfg.kcal != 0) {
+		// beim Einlernen zhlen die Rohwerte
+		menu_calKey (key);
+		return;
 	}
+#endif
+
+	// Rohwert ber die Tastentabelle in MENU_KEY_* wandeln, 0xFF = keine Taste
+	if (key != 0xFF)
+		key = menu_decodeKey (key);
 
 	// Taste prfen
 	if (menu_cfg.keyLast != key) {
@@ -1301,6 +2823,18 @@ void menu_readKey (uint8_t key)
 		menu_cfg.keyCnt = 0;
 		menu_cfg.key = 0xFF;
 
+#if DSPL_OFF_S > 0
+		if (key != 0xFF) {
+			menu_cfg.idle = 0;
+
+			if (dspl.off != 0) {
+				// sofort aufwecken, ohne Entprellen; die Taste gilt als gemeldet und wirkt nicht
+				dspl_on ();
+				menu_cfg.keyCnt = MENU_KEY_DONE;
+			}
+		}
+#endif
+
 	} else if (key != 0xFF) {
 		// gltige Taste erkannt
 		if (menu_cfg.keyCnt < MENU_KEY_CNT_MIN) {
@@ -1310,29 +2844,82 @@ void menu_readKey (uint8_t key)
 		} else if (menu_cfg.keyCnt == MENU_KEY_CNT_MIN) {
 			// Taste bernehmen
 			menu_cfg.key = key;
+			menu_cfg.keyRep = 0;
 			// nur einmal zhlen
 			menu_cfg.keyCnt++;
 
 			// nderungsbit setzen
-			menu_cfg.changed = 1;
+			menu_cfg.changed |= MENU_CHG_FULL;
 
-		} else {
+		} else if (menu_cfg.keyCnt == MENU_KEY_DONE) {
 			// wurde bereits gemeldet, Rcksetzen erfolgt ggf. nach Bearbeitung
+
+		} else if ((key == MENU_KEY_UP || key == MENU_KEY_DOWN)
+				&& menu_cfg.menu >= MENU_EDIT_CH1_ON && menu_cfg.menu <= MENU_EDIT_LAST)
+		{
+			// gehalten: nach der Verzgerung wiederholen, die Schrittweite wchst mit keyRep
+			if (++menu_cfg.keyCnt >= MENU_KEY_CNT_MIN + 1 + MENU_KEY_REP_DELAY) {
+				menu_cfg.keyCnt -= MENU_KEY_REP_RATE;
+
+				menu_cfg.key = key;
+				if (menu_cfg.keyRep < 2 * MENU_KEY_REP_FAST)
+					menu_cfg.keyRep++;
+				menu_cfg.changed |= MENU_CHG_FULL;
+			}
+
+		} else if (key == MENU_KEY_MENU || key == MENU_KEY_OK) {
+			// lange gehalten: eigenes Ereignis nach dem kurzen, dann Ruhe bis zum Loslassen
+			if (++menu_cfg.keyCnt >= MENU_KEY_CNT_MIN + 1 + MENU_KEY_LONG_CNT) {
+				menu_cfg.keyCnt = MENU_KEY_DONE;
+
+				menu_cfg.key = key | MENU_KEY_LONG;
+				menu_cfg.changed |= MENU_CHG_FULL;
+			}
+
+		} else {
+			// keine Wiederholung
+			menu_cfg.keyCnt = MENU_KEY_DONE;
 		}
 	}
 }
 
 void menu_printMenu (void)
 {
-	uint8_t		menu;
+	uint8_t		menu, chg;
 	uint8_t		i, id;
 	int16_t		chId;
+	int8_t		cmp;
+
+#if MENU_KEY_CAL
+	if (menu_cfg.kcal != 0) {
+		// Einlernen: oben C und der Platz, unten der Rohwert der Taste
+		if (menu_cfg.changed != 0) {
+			menu_cfg.changed = 0;
+			dspl_hex_uint8 (0, 0xC0 + menu_cfg.kcal - 1);
+			dspl_hex_uint8 (1, menu_cfg.keyLast);
+		}
+		return;
+	}
+#endif
 
 	// Anzeige nur bei nderungen aktualisieren
 	if (menu_cfg.changed != 0) {
-		// Bit zurcksetzen
+		// Bits zurcksetzen
+		chg = menu_cfg.changed;
 		menu_cfg.changed = 0;
 
+		if (chg == MENU_CHG_FLASH) {
+			// nur Blinken: nichts neu berechnen
+			dspl_blank ((menu_cfg.flash != 0) ? menu_cfg.flash_rows : 0);
+			return;
+		}
+
+		if (chg & MENU_CHG_FULL) {
+			// Zeilen neu aufbauen, auch wenn sich der Messwert nicht gendert hat
+			menu_cfg.shown = 0;
+		}
+		menu_cfg.flash_rows = 0;
+
 		// zwischenspeichern fr die nderungserkennung
 		menu = menu_cfg.menu;
 
@@ -1344,37 +2931,122 @@ void menu_printMenu (void)
 			// Text in der ersten Zeile
 			dspl_text (0, menu_setup.text_id);
 
-			// Blinkender Parameterwert in der zweiten Zeile
-			if (menu_cfg.flash != 0)
-				dspl_text (1, TEXT_ID_BLANK);
+			// Parameterwert in der zweiten Zeile
+			if (menu_setup.para >= CFG_PARA_RES1)
+				dspl_int8 (1, 0, temp_cfg.para[menu_setup.para]);	// Bit, ohne Nachkommastelle
 			else
 				dspl_int8 (1, 1, temp_cfg.para[menu_setup.para]);
 
+			// beim Einstellen blinkt er
+			if (menu_cfg.menu >= MENU_EDIT_CH1_ON && menu_cfg.menu <= MENU_EDIT_LAST)
+				menu_cfg.flash_rows = _BV(1);
+
+#if DSPL_DIM
+			// Helligkeit sofort bernehmen, nach Abbruch auch den wiederhergestellten Wert
+			if (menu_setup.para == CFG_PARA_BRIGHT)
+				dspl_updBright ();
+#endif
+
 		} else {
 
 			if (menu_setup.para == MENU_PARA_TEMP) {
-				// aktuelle Temperaturwerte
+				// aktuelle Temperaturwerte der beiden Anzeigekanle
+				for (i = 0; i < TEMP_HIST_CH_NO; i++) {
+					id = temp_hist.chan[i];
+
+					if (id >= ONE_WIRE_DEV_NO) {
+						// kein Sensor mit dieser Rolle -> dunkel
+						if ((menu_cfg.shown & _BV(i)) == 0)
+							dspl_text  (i, TEXT_ID_BLANK);
+						menu_cfg.shown |= _BV(i);
+						continue;
+					}
 
-				// wenn ungltig -> Blinken
-				if (temp_hist.valid[0] == 0 && menu_cfg.flash != 0) {
-					dspl_text  (0, TEXT_ID_BLANK);
-				} else {
+					// ungltig -> Blinken
+					if (TEMP_VALID(id) == 0)
+						menu_cfg.flash_rows |= _BV(i);
+
+					// unvernderter Messwert kostet nichts
+					if ((menu_cfg.shown & _BV(i)) != 0 && menu_cfg.shown_val[i] == temp_hist.value[id])
+						continue;
+
+					menu_cfg.shown |= _BV(i);
+					menu_cfg.shown_val[i] = temp_hist.value[id];
 #if TEMP_VAL_MAX > INT8_MAX
-					dspl_int16 (0, 1, temp_hist.value[0]);
+					dspl_int16 (i, 1, temp_hist.value[id]);
 #else
-					dspl_int8  (0, 1, temp_hist.value[0]);
+					dspl_int8  (i, 1, temp_hist.value[id]);
 #endif
 				}
-				// wenn ungltig -> Blinken
-				if (temp_hist.valid[1] == 0 && menu_cfg.flash != 0) {
-					dspl_text  (1, TEXT_ID_BLANK);
+#if ONE_WIRE_ENABLE
+			} else if (menu_setup.para >= MENU_PARA_SENSOR && menu_setup.para <= MENU_PARA_CAL
+					&& menu_cfg.sensor > oneWire.dev_count + 1) {
+				// Tastenkanal: oben Rohwert, unten Rauschen der letzten Sekunde in LSB
+				dspl_int16 (0, 0, adc_data.mem[ADC_KEY_SRC - ADMUX_MIN]);
+				dspl_int16 (1, 0, menu_cfg.key_pp);
+
+			} else if (menu_setup.para >= MENU_PARA_SENSOR && menu_setup.para <= MENU_PARA_CAL
+					&& menu_cfg.sensor > oneWire.dev_count) {
+				// Busbelegung einer Leserunde in ms: oben kurz gelesen, unten komplett mit CRC
+				dspl_int16 (0, 1, oneWire.read_last[0] / 10);
+				dspl_int16 (1, 1, oneWire.read_last[1] / 10);
+
+			} else if (menu_setup.para >= MENU_PARA_SENSOR && menu_setup.para <= MENU_PARA_CAL
+					&& menu_cfg.sensor == oneWire.dev_count) {
+				// hinter dem letzten Sensor: Zeitschlitze der letzten Hintergrundsuche,
+				// oben blinkend die dabei verschwundenen Sensoren als Bitmaske
+				if (oneWire.scan_lost != 0) {
+					dspl_hex_uint8 (0, oneWire.scan_lost);
+					menu_cfg.flash_rows |= _BV(0);
 				} else {
+					dspl_text  (0, TEXT_ID_ON_WIRE);
+				}
+				dspl_int16 (1, 0, oneWire.scan_slots);
+			} else if (menu_setup.para == MENU_PARA_DIAG) {
+				// einzelner Sensor: Nummer.Seite, z.B. 3.2 = Timeouts von Sensor 3
+				id = menu_cfg.sensor;
+				dspl_int16 (0, 1, (id + 1) * 10 + menu_cfg.diag);
+
+				switch (menu_cfg.diag)
+				{
+				case 0:		// Gesundheitswert
+					dspl_int16 (1, 0, TEMP_HEALTH_MAX - (oneWire.sens[id].health >> 4) * TEMP_HEALTH_ERR);
+					break;
+				case 1:		// kein Presence-Pulse
+					dspl_int16 (1, 0, oneWire.sens[id].err & TEMP_ERR_PRES);
+					break;
+				case 2:		// Konvertierungs-Timeouts am Bus
+					dspl_int16 (1, 0, oneWire.conv_err);
+					break;
+				default:	// CRC-Fehler
+					dspl_int16 (1, 0, oneWire.sens[id].err >> 4);
+					break;
+				}
+#if TEMP_SENSOR_CAL
+			} else if (menu_setup.para == MENU_PARA_CAL) {
+				// Nummer.Wert: 3.0 = Offset von Sensor 3 in 0.1 C, 3.1 = Verstrkung in 0.1 %
+				id = menu_cfg.sensor;
+				dspl_int16 (0, 1, (id + 1) * 10 + menu_cfg.cal);
+
+				if (menu_cfg.cal == 0)
+					dspl_int16 (1, 1, ((int8_t)oneWire.sens[id].cal_tl * 10) / 16);
+				else
+					dspl_int16 (1, 1, (TEMP_CAL_GAIN(oneWire.sens[id].cal_th) * 125) / 16);
+#endif
+#endif
+			} else if (menu_setup.para == MENU_PARA_SENSOR) {
+				// einzelner Sensor: Nummer.Rolle in der ersten Zeile, z.B. 3.2 = Sensor 3 auen
+				id = menu_cfg.sensor;
+				dspl_int16 (0, 1, (id + 1) * 10 + TEMP_ROLE_GET(id));
+
+				// Messwert, wenn ungltig -> Blinken
+				if (TEMP_VALID(id) == 0)
+					menu_cfg.flash_rows = _BV(1);
 #if TEMP_VAL_MAX > INT8_MAX
-					dspl_int16 (1, 1, temp_hist.value[1]);
+				dspl_int16 (1, 1, temp_hist.value[id]);
 #else
-					dspl_int8  (1, 1, temp_hist.value[1]);
+				dspl_int8  (1, 1, temp_hist.value[id]);
 #endif
-				}
 			} else {
 				// MinMax-Verlauf: Index ausrechnen
 				id = temp_hist.index;
@@ -1398,9 +3070,9 @@ void menu_printMenu (void)
 					chId += 100;
 					dspl_int16 (0, 2, chId);
 #if TEMP_VAL_MAX > INT8_MAX
-					dspl_int16 (1, 1, temp_hist.max_array[0][id]);
+					dspl_int16 (1, 1, TEMP_HIST_TO_VAL(temp_hist.max_array[0][id]));
 #else
-					dspl_int8 (1, 1, temp_hist.max_array[0][id]);
+					dspl_int8 (1, 1, TEMP_HIST_TO_VAL(temp_hist.max_array[0][id]));
 #endif
 					break;
 
@@ -1409,9 +3081,9 @@ void menu_printMenu (void)
 					chId += 200;
 					dspl_int16 (0, 2, chId);
 #if TEMP_VAL_MAX > INT8_MAX
-					dspl_int16 (1, 1, temp_hist.max_array[1][id]);
+					dspl_int16 (1, 1, TEMP_HIST_TO_VAL(temp_hist.max_array[1][id]));
 #else
-					dspl_int8 (1, 1, temp_hist.max_array[1][id]);
+					dspl_int8 (1, 1, TEMP_HIST_TO_VAL(temp_hist.max_array[1][id]));
 #endif
 					break;
 
@@ -1421,9 +3093,9 @@ void menu_printMenu (void)
 					chId *= -1;
 					dspl_int16 (0, 2, chId);
 #if TEMP_VAL_MAX > INT8_MAX
-					dspl_int16 (1, 1, temp_hist.min_array[0][id]);
+					dspl_int16 (1, 1, TEMP_HIST_TO_VAL(temp_hist.min_array[0][id]));
 #else
-					dspl_int8 (1, 1, temp_hist.min_array[0][id]);
+					dspl_int8 (1, 1, TEMP_HIST_TO_VAL(temp_hist.min_array[0][id]));
 #endif
 					break;
 
@@ -1433,9 +3105,9 @@ void menu_printMenu (void)
 					chId *= -1;
 					dspl_int16 (0, 2, chId);
 #if TEMP_VAL_MAX > INT8_MAX
-					dspl_int16 (1, 1, temp_hist.min_array[1][id]);
+					dspl_int16 (1, 1, TEMP_HIST_TO_VAL(temp_hist.min_array[1][id]));
 #else
-					dspl_int8 (1, 1, temp_hist.min_array[1][id]);
+					dspl_int8 (1, 1, TEMP_HIST_TO_VAL(temp_hist.min_array[1][id]));
 #endif
 					break;
 
@@ -1465,9 +3137,21 @@ void menu_printMenu (void)
 			}
 		}
 
+		// blinkende Zeilen gleich im richtigen Zustand bernehmen
+		dspl_blank ((menu_cfg.flash != 0) ? menu_cfg.flash_rows : 0);
+
+		// Vergleichswert fr Hoch/Runter, ohne Vergleichsparameter wird er nie erreicht
+		if (menu_setup.para_cmp < CFG_PARA_END)
+			cmp = temp_cfg.para[menu_setup.para_cmp];
+		else
+			cmp = INT8_MIN;
+
 		// Tastendruck behandeln
 		switch (menu_cfg.key)
 		{
+		case MENU_KEY_HOME:
+		case MENU_KEY_UP | MENU_KEY_DOWN:
+		case MENU_KEY_MENU | MENU_KEY_LONG:
 		case MENU_KEY_MENU:
 			if (menu_setup.para < CFG_PARA_END) {
 				// ungespeicherten Wert wiederherstellen
@@ -1477,12 +3161,19 @@ void menu_printMenu (void)
 				case CFG_PARA_CH1_OFF:	temp_cfg.para[menu_setup.para] = temp_ee_cfg.ch1_off;	break;
 				case CFG_PARA_CH2_ON:	temp_cfg.para[menu_setup.para] = temp_ee_cfg.ch2_on;	break;
 				case CFG_PARA_CH2_OFF:	temp_cfg.para[menu_setup.para] = temp_ee_cfg.ch2_off;	break;
+				case CFG_PARA_RES1:		temp_cfg.para[menu_setup.para] = TEMP_CFG_RES_MIN + TEMP_RES_CODE(temp_ee_cfg.resolution, 0);	break;
+				case CFG_PARA_RES2:		temp_cfg.para[menu_setup.para] = TEMP_CFG_RES_MIN + TEMP_RES_CODE(temp_ee_cfg.resolution, 1);	break;
+				case CFG_PARA_BRIGHT:	temp_cfg.para[menu_setup.para] = temp_ee_cfg.bright;	break;
 
 				default:
 					break;
 				}
 			}
-			if (menu_setup.menu_key_menu < MENU_NO) {
+			if (menu_cfg.key != MENU_KEY_MENU) {
+				// Zusatztaste, Hoch+Runter bzw. MENU lang: wie MENU abbrechen, aber gleich zur Temperaturanzeige
+				menu = MENU_TEMP_VALUE;
+
+			} else if (menu_setup.menu_key_menu < MENU_NO) {
 				// Folgemen
 				menu = menu_setup.menu_key_menu;
 
@@ -1494,7 +3185,7 @@ void menu_printMenu (void)
 					menu_cfg.minMaxId++;
 
 				// Men aktualisieren
-				menu_cfg.changed = 1;
+				menu_cfg.changed |= MENU_CHG_FULL;
 			}
 			break;
 
@@ -1504,14 +3195,32 @@ void menu_printMenu (void)
 				menu = menu_setup.menu_key_up;
 
 			} else if (menu_setup.para < CFG_PARA_END) {
-				// Parameter inkrementieren
-				temp_cfg.para[menu_setup.para] =
-					menu_incr (	temp_cfg.para[menu_setup.para],
-								temp_cfg.para[menu_setup.para_cmp],
-								menu_setup.para_max);
+				// Parameter inkrementieren, beim Halten in greren Schritten
+				for (i = MENU_KEY_STEP(menu_cfg.keyRep); i > 0; i--)
+					temp_cfg.para[menu_setup.para] =
+						menu_incr (	temp_cfg.para[menu_setup.para],
+									cmp,
+									menu_setup.para_max);
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+#if ONE_WIRE_ENABLE
+			} else if (menu_setup.para >= MENU_PARA_SENSOR && menu_setup.para <= MENU_PARA_DIAG) {
+				// nchster Sensor, danach Such- und Lesestatistik, berlauf abfangen
+				if (++menu_cfg.sensor > oneWire.dev_count + 2)
+					menu_cfg.sensor = 0;
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+#if TEMP_SENSOR_CAL
+			} else if (menu_setup.para == MENU_PARA_CAL && menu_cfg.sensor < oneWire.dev_count) {
+				// Kalibrierwert erhhen, gilt sofort, gespeichert wird mit OK
+				temp_adjCal (menu_cfg.sensor, 1);
 
 				// Men aktualisieren
-				menu_cfg.changed = 1;
+				menu_cfg.changed |= MENU_CHG_FULL;
+#endif
+#endif
 			} else {
 				// nichts tun
 			}
@@ -1523,14 +3232,34 @@ void menu_printMenu (void)
 				menu = menu_setup.menu_key_down;
 
 			} else if (menu_setup.para < CFG_PARA_END) {
-				// Parameter dekrementieren
-				temp_cfg.para[menu_setup.para] =
-					menu_decr (	temp_cfg.para[menu_setup.para],
-								temp_cfg.para[menu_setup.para_cmp],
-								menu_setup.para_min);
+				// Parameter dekrementieren, beim Halten in greren Schritten
+				for (i = MENU_KEY_STEP(menu_cfg.keyRep); i > 0; i--)
+					temp_cfg.para[menu_setup.para] =
+						menu_decr (	temp_cfg.para[menu_setup.para],
+									cmp,
+									menu_setup.para_min);
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+#if ONE_WIRE_ENABLE
+			} else if (menu_setup.para >= MENU_PARA_SENSOR && menu_setup.para <= MENU_PARA_DIAG) {
+				// vorheriger Sensor, Unterlauf abfangen
+				if (menu_cfg.sensor > 0)
+					menu_cfg.sensor--;
+				else
+					menu_cfg.sensor = oneWire.dev_count + 2;
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+#if TEMP_SENSOR_CAL
+			} else if (menu_setup.para == MENU_PARA_CAL && menu_cfg.sensor < oneWire.dev_count) {
+				// Kalibrierwert verringern
+				temp_adjCal (menu_cfg.sensor, -1);
 
 				// Men aktualisieren
-				menu_cfg.changed = 1;
+				menu_cfg.changed |= MENU_CHG_FULL;
+#endif
+#endif
 			} else {
 				// nichts tun
 			}
@@ -1553,10 +3282,51 @@ void menu_printMenu (void)
 					menu_cfg.minMaxId--;
 
 				// Men aktualisieren
-				menu_cfg.changed = 1;
+				menu_cfg.changed |= MENU_CHG_FULL;
+
+			} else if (menu_setup.para == MENU_PARA_SENSOR && menu_cfg.sensor < oneWire.dev_count) {
+				// Rolle des angezeigten Sensors weiterschalten und sofort speichern
+				i = TEMP_ROLE_GET(menu_cfg.sensor);
+				temp_ee_cfg.roles ^= (uint16_t)(i ^ ((i + 1) & 0x03)) << (2 * menu_cfg.sensor);
+				menu_saveConfig ();
+
+#if TEMP_SENSOR_CAL
+				// und im Sensor selbst
+				oneWire.sens[menu_cfg.sensor].cal_th = TEMP_CAL_ROLE_SET(oneWire.sens[menu_cfg.sensor].cal_th, (i + 1) & 0x03);
+				oneWire.cal_req |= _BV(menu_cfg.sensor);
+#endif
+
+				// Anzeigekanle neu zuordnen
+				temp_updRoles ();
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+
+			} else if (menu_setup.para == MENU_PARA_DIAG) {
+				// nchster Diagnosewert
+				menu_cfg.diag = (menu_cfg.diag + 1) & 0x03;
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+#if TEMP_SENSOR_CAL
+			} else if (menu_setup.para == MENU_PARA_CAL && menu_cfg.sensor < oneWire.dev_count) {
+				// Kalibrierung in den Sensor schreiben, danach der andere Wert
+				oneWire.cal_req |= _BV(menu_cfg.sensor);
+				menu_cfg.cal ^= 1;
+
+				// Men aktualisieren
+				menu_cfg.changed |= MENU_CHG_FULL;
+#endif
 			}
 			break;
 
+#if DSPL_OFF_S > 0
+		case MENU_KEY_OK | MENU_KEY_LONG:
+			// OK lang: Anzeige sofort aus, das kurze OK wurde schon ausgefhrt
+			dspl_off ();
+			break;
+#endif
+
 		default:
 			// nichts tun
 			break;
@@ -1565,7 +3335,7 @@ void menu_printMenu (void)
 		// neues Men bernehmen, nderungsbit setzen
 		if (menu_cfg.menu != menu) {
 			menu_cfg.menu = menu;
-			menu_cfg.changed = 1;
+			menu_cfg.changed |= MENU_CHG_FULL;
 		}
 
 		// Tastendruck immer erstmal zurcksetzen
@@ -1610,8 +3380,8 @@ void menu_loadConfig (void)
 	uint8_t	cnt1, cnt2;
 
 	// die ersten beiden Schreibzhler lesen
-	cnt1 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + 0 * sizeof(temp_ee_cfg)));
-	cnt2 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + 1 * sizeof(temp_ee_cfg)));
+	cnt1 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + 0 * TEMP_CFG_EE_SIZE));
+	cnt2 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + 1 * TEMP_CFG_EE_SIZE));
 	// vergleichen
 	if (cnt1 == cnt2) {
 		// die ersten beiden sind identisch -> noch nie beschrieben -> Standardwerte
@@ -1625,7 +3395,7 @@ void menu_loadConfig (void)
 		// Diskontinuitt suchen
 		for (i = 0; i < TEMP_CFG_EE_COUNT; i++) {
 			// ersten Schreibzhler lesen
-			cnt1 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + i * sizeof(temp_ee_cfg)));
+			cnt1 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + i * TEMP_CFG_EE_SIZE));
 
 			// Adresse inkrementieren, berlauf abfangen
 			j = i + 1;
@@ -1633,7 +3403,7 @@ void menu_loadConfig (void)
 				j = 0;
 
 			// nchsten Schreibzhler lesen
-			cnt2 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + j * sizeof(temp_ee_cfg)));
+			cnt2 = eeprom_read_byte ((const void *)(TEMP_CFG_EE_OFFSET + j * TEMP_CFG_EE_SIZE));
 
 			// prfen
 			if (cnt1 != (cnt2 + 1)) {
@@ -1654,18 +3424,41 @@ void menu_loadConfig (void)
 	// am Ende den zuletzt beschriebenen Eintrag laden
 	if (temp_cfg.cfg_id < TEMP_CFG_EE_COUNT) {
 		// ganzen Block lesen
-		eeprom_read_block (&temp_ee_cfg, (const void *)(TEMP_CFG_EE_OFFSET + temp_cfg.cfg_id * sizeof(temp_ee_cfg)), sizeof(temp_ee_cfg));
+		eeprom_read_block (&temp_ee_cfg, (const void *)(TEMP_CFG_EE_OFFSET + temp_cfg.cfg_id * TEMP_CFG_EE_SIZE), sizeof(temp_ee_cfg));
 
 #if 0
 		// fr's Schreiben zum nchsten Eintrag weiterschieben, berlauf abfangen
 		if (++temp_cfg.cfg_id >= TEMP_CFG_EE_COUNT)
 			temp_cfg.cfg_id = 0;
 #endif
+
+		// Block einer lteren Version oder gelscht: die Schaltschwellen bernehmen,
+		// alles hinter der Kennung ist ungltig und bekommt die Standardwerte
+		if (temp_ee_cfg.layout != TEMP_CFG_LAYOUT) {
+			// auch die Schwellen gelscht -> ganz auf Standardwerte
+			if ((temp_ee_cfg.ch1_on & temp_ee_cfg.ch1_off & temp_ee_cfg.ch2_on & temp_ee_cfg.ch2_off) == -1)
+				temp_cfg.cfg_id = 0xFF;
+
+			temp_ee_cfg.layout = TEMP_CFG_LAYOUT;
+			temp_ee_cfg.resolution = 0xFFFF;
+			temp_ee_cfg.roles = 0xFFFF;
+			temp_ee_cfg.bright = 0xFF;
+		}
+	}
+
+	if (temp_cfg.cfg_id < TEMP_CFG_EE_COUNT) {
 		// Parameter kopieren
 		temp_cfg.para[CFG_PARA_CH1_ON]  = temp_ee_cfg.ch1_on;
 		temp_cfg.para[CFG_PARA_CH1_OFF] = temp_ee_cfg.ch1_off;
 		temp_cfg.para[CFG_PARA_CH2_ON]  = temp_ee_cfg.ch2_on;
 		temp_cfg.para[CFG_PARA_CH2_OFF] = temp_ee_cfg.ch2_off;
+		temp_cfg.para[CFG_PARA_RES1]    = TEMP_CFG_RES_MIN + TEMP_RES_CODE(temp_ee_cfg.resolution, 0);
+		temp_cfg.para[CFG_PARA_RES2]    = TEMP_CFG_RES_MIN + TEMP_RES_CODE(temp_ee_cfg.resolution, 1);
+
+		// Helligkeit, gelschtes EEPROM ergibt volle Helligkeit
+		if (temp_ee_cfg.bright < DSPL_CFG_BRIGHT_MIN || temp_ee_cfg.bright > DSPL_CFG_BRIGHT_MAX)
+			temp_ee_cfg.bright = DSPL_CFG_BRIGHT_MAX;
+		temp_cfg.para[CFG_PARA_BRIGHT]  = temp_ee_cfg.bright;
 
 #if 0
 		// Parameter prfen
@@ -1719,11 +3512,20 @@ void menu_loadConfig (void)
 		temp_cfg.para[CFG_PARA_CH2_ON] = 20;
 		temp_cfg.para[CFG_PARA_CH2_OFF] = 10;
 
+		temp_cfg.para[CFG_PARA_RES1] = TEMP_CFG_RES_MAX;
+		temp_cfg.para[CFG_PARA_RES2] = TEMP_CFG_RES_MAX;
+
+		temp_cfg.para[CFG_PARA_BRIGHT] = DSPL_CFG_BRIGHT_MAX;
+
 		// Daten kopieren
 		temp_ee_cfg.ch1_on  = temp_cfg.para[CFG_PARA_CH1_ON];
 		temp_ee_cfg.ch1_off = temp_cfg.para[CFG_PARA_CH1_OFF];
 		temp_ee_cfg.ch2_on  = temp_cfg.para[CFG_PARA_CH2_ON];
 		temp_ee_cfg.ch2_off = temp_cfg.para[CFG_PARA_CH2_OFF];
+		temp_ee_cfg.layout = TEMP_CFG_LAYOUT;
+		temp_ee_cfg.resolution = 0xFFFF;
+		temp_ee_cfg.roles = 0xFFFF;
+		temp_ee_cfg.bright = temp_cfg.para[CFG_PARA_BRIGHT];
 
 		temp_ee_cfg.counter = 0;
 	}
@@ -1731,17 +3533,29 @@ void menu_loadConfig (void)
 
 void menu_saveConfig (void)
 {
+#if TEMP_ALARM_MODE
+	// in der nchsten Runde alle Sensoren lesen, dabei werden die neuen Alarmgrenzen geschrieben
+	oneWire.alarm_cnt = 0;
+#endif
+
 	// Daten kopieren
 	temp_ee_cfg.ch1_on  = temp_cfg.para[CFG_PARA_CH1_ON];
 	temp_ee_cfg.ch1_off = temp_cfg.para[CFG_PARA_CH1_OFF];
 	temp_ee_cfg.ch2_on  = temp_cfg.para[CFG_PARA_CH2_ON];
 	temp_ee_cfg.ch2_off = temp_cfg.para[CFG_PARA_CH2_OFF];
 
+	// Auflsung der ersten beiden Sensoren, die brigen Bits bleiben erhalten
+	temp_ee_cfg.resolution &= ~0x000F;
+	temp_ee_cfg.resolution |= (temp_cfg.para[CFG_PARA_RES1] - TEMP_CFG_RES_MIN) << 0;
+	temp_ee_cfg.resolution |= (temp_cfg.para[CFG_PARA_RES2] - TEMP_CFG_RES_MIN) << 2;
+
+	temp_ee_cfg.bright = temp_cfg.para[CFG_PARA_BRIGHT];
+
 	// Zhler erhhen
 //	temp_ee_cfg.counter++;
 
 	// ganzen Block schreiben
-	eeprom_write_block (&temp_ee_cfg, (void *)(TEMP_CFG_EE_OFFSET + temp_cfg.cfg_id * sizeof(temp_ee_cfg)), sizeof(temp_ee_cfg));
+	eeprom_write_block (&temp_ee_cfg, (void *)(TEMP_CFG_EE_OFFSET + temp_cfg.cfg_id * TEMP_CFG_EE_SIZE), sizeof(temp_ee_cfg));
 
 #if 0
 	// zum nchsten Eintrag weiterschieben, berlauf abfangen
@@ -1752,671 +3566,2025 @@ void menu_saveConfig (void)
 
 void temp_startTemp (void)
 {
-	if (oneWire_reset() != 0) {
-		// Adresse berspringen
-		oneWire_writeByte (ONE_WIRE_CMD_SKIP_ROM);
+	uint8_t		code, spu;
+#if TEMP_CONV_SINGLE
+	uint8_t		n;
+#else
+	uint8_t		i;
+#endif
+
+	oneWire.job_conv.flags = ONE_WIRE_JOB_RESET;
+#if TEMP_CONV_SINGLE
+	// nur den aktuellen Sensor adressieren
+	n = temp_addrDev ();
+	oneWire.cmd[n] = ONE_WIRE_CMD_CONVERT_T;
 
-		// Kommando senden
-		oneWire_writeByte (ONE_WIRE_CMD_CONVERT_T);
+	oneWire.job_conv.wr_data = oneWire.cmd;
+	oneWire.job_conv.wr_count = n + 1;
+
+	// starker Pull-Up nur, wenn dieser Sensor parasitr versorgt ist
+	code = TEMP_RES_CODE(temp_ee_cfg.resolution, oneWire.dev);
+	spu = oneWire.parasite & _BV(oneWire.dev);
+#else
+	// Adresse berspringen, Kommando an alle Sensoren senden
+	oneWire.cmd[0] = ONE_WIRE_CMD_SKIP_ROM;
+	oneWire.cmd[1] = ONE_WIRE_CMD_CONVERT_T;
+
+	oneWire.job_conv.wr_data = oneWire.cmd;
+	oneWire.job_conv.wr_count = 2;
+
+	// starker Pull-Up fr alle, solange der langsamste Sensor braucht
+	code = 0;
+	for (i = 0; i < oneWire.dev_count; i++) {
+		if (code < TEMP_RES_CODE(temp_ee_cfg.resolution, i))
+			code = TEMP_RES_CODE(temp_ee_cfg.resolution, i);
 	}
-}
+	spu = oneWire.parasite;
+#endif
 
-void temp_readTemp (void)
-{
-	int16_t		temp;
-	uint8_t		*data;
-	uint8_t		i, i_max, n;
-	uint8_t		byte;
+	if (spu != 0) {
+		// die Engine schaltet den Pull-Up direkt nach dem letzten Bit ein,
+		// Abfragen geht dann nicht, es wird die Zeit laut Datenblatt gewartet
+		oneWire.job_conv.flags |= ONE_WIRE_JOB_SPU;
+		oneWire.spu_ticks = TEMP_CONV_TICKS(code);
+	}
+	oneWire.job_conv.rd_count = 0;
+	oneWire.job_conv.done = 0;
 
-	// maximal 2 Sensoren einlesen und speichern
-	if (oneWire.dev_count < 2)
-		i_max = oneWire.dev_count;
-	else
-		i_max = 2;
+	// ab jetzt wird gezhlt und abgefragt
+	oneWire.state = (oneWire.job_conv.flags & ONE_WIRE_JOB_SPU) ? TEMP_ST_POWER : TEMP_ST_CONV;
+	oneWire.conv_cnt = 0;
 
-	for (i = 0; i < i_max; i++) {
-		// Bit zurcksetzen
-		temp_hist.valid[i] = 0;
+	oneWire_submit (&oneWire.job_conv);
+}
 
-		// Sensor addressieren
-		if (oneWire_selectDev(i) != 0) {
-			// CRC zurcksetzen
-			oneWire.crc8 = 0;
+void temp_task (void)
+{
+#if TEMP_SENSOR_CAL || ONE_WIRE_SCAN_S > 0
+	uint8_t		i;
+#endif
 
-			// Kommando: Speicher lesen
-			oneWire_writeByte (ONE_WIRE_CMD_RD_SCRATCH);
+	/*
+	 * Wird mit jeder Erfassung (alle 12ms) aufgerufen. Whrend der Konvertierung
+	 * liefert der DS18B20 in Lese-Zeitschlitzen 0, danach 1. Sobald das 1 kommt,
+	 * wird das Scratchpad gelesen und gleich die nchste Konvertierung gestartet,
+	 * bei 9 Bit Auflsung also etwa alle 100ms statt einmal pro Sekunde.
+	 */
+	switch (oneWire.state)
+	{
+	case TEMP_ST_IDLE:
+#if ONE_WIRE_SCAN_S > 0
+		if (oneWire.scan_req != 0) {
+			// zwischen zwei Runden gehrt der Bus der Hintergrundsuche
+			oneWire.scan_req = 0;
+			temp_scanStart ();
+			break;
+		}
+		if (oneWire.setup_req != 0) {
+			// von der Suche neu gefundene Sensoren vor der nchsten Runde einrichten
+			for (i = 0; (oneWire.setup_req & _BV(i)) == 0; i++)
+				;
+			oneWire.setup_req &= ~_BV(i);
+			temp_setupDev (i);
+			break;
+		}
+#endif
+#if TEMP_SENSOR_CAL
+		if (oneWire.cal_req != 0) {
+			// genderte Kalibrierung zwischen zwei Runden in den Sensor schreiben
+			for (i = 0; (oneWire.cal_req & _BV(i)) == 0; i++)
+				;
+			oneWire.cal_req &= ~_BV(i);
+			temp_writeCal (i);
+			break;
+		}
+#endif
+		// ohne Sensoren gibt es nichts zu tun
+		if (oneWire.dev_count == 0)
+			break;
 
-			// uint8-Zeiger auf den Zielspeicher
-			data = ((uint8_t *)&oneWire.data);
+		// Busbelegung der letzten Runde merken
+		oneWire.read_last[oneWire.fast_cnt == 0] = oneWire.read_time;
+		oneWire.read_time = 0;
 
-			// 9 Byte lesen
-			for (n = 0; n < 9; n++, data++) {
-				// Byte lesen
-				byte = oneWire_readByte ();
-				// speichern
-				*data = byte;
+#if TEMP_FAST_READ
+		// alle TEMP_FAST_FULL Runden komplett lesen
+		if (++oneWire.fast_cnt >= TEMP_FAST_FULL)
+			oneWire.fast_cnt = 0;
+#endif
 
-				// CRC aktualisieren
-				oneWire_updateCRC (byte);
-			}
+		// neue Runde mit dem ersten Sensor
+		oneWire.dev = 0;
+		temp_startTemp ();
+		break;
 
-			// crc prfen
-			if (oneWire.crc8 == 0) {
-				// Daten verarbeiten, 12Bit Auflsung ist Standard
-				// 2 Byte zusammenfhren
-				temp = (oneWire.data.temp_hi << 8) | oneWire.data.temp_lo;
+	case TEMP_ST_SCAN:
+	case TEMP_ST_ALARM:
+		// die Suche luft in der Hauptschleife
+		break;
 
-				// 1 Bit entspricht 0.0625 C = 1 / 16 C
-#if TEMP_VAL_MAX > INT8_MAX
-				// mal (0.0625 * 10) => mal 10 durch 16
-				temp *= 10;
-				temp >>= 4;	// /= 16;
-#else
-				// Das wirft die Nachkommastellen weg, und es reicht int8!
-				temp /= 16;
+	case TEMP_ST_SETUP:
+		// die Kette luft ber die Rckrufe
+		break;
+
+#if TEMP_SENSOR_CAL
+	case TEMP_ST_COPY:
+		// die Wartezeit beginnt erst nach COPY SCRATCHPAD
+		if (ONE_WIRE_JOB_PENDING(oneWire.job_read))
+			break;
+		if (++oneWire.conv_cnt >= TEMP_COPY_TICKS) {
+			// EEPROM des Sensors sicher beschrieben
+			temp_copyDone ();
+		}
+		break;
 #endif
 
-				// aktuellen Wert speichern
-				temp_hist.value[i] = temp;
+	case TEMP_ST_POWER:
+		// CONVERT_T noch nicht gesendet, die Wartezeit beginnt erst danach
+		if (ONE_WIRE_JOB_PENDING(oneWire.job_conv))
+			break;
+		if (++oneWire.conv_cnt >= oneWire.spu_ticks) {
+			// Konvertierung sicher fertig, Pull-Up aus und lesen
+			ONE_WIRE_SPU_OFF;
+			temp_convDone ();
+		}
+		break;
 
-				// Wert ist gltig
-				temp_hist.valid[i] = 1;
+	case TEMP_ST_CONV:
+		// Nach temp_nextDev () aus einem Rckruf kann CONVERT_T noch in der
+		// Warteschlange stehen, job_conv darf erst danach neu belegt werden
+		if (ONE_WIRE_JOB_PENDING(oneWire.job_conv))
+			break;
+		if (++oneWire.conv_cnt >= TEMP_CONV_TIMEOUT) {
+			// keine Antwort (z.B. parasitr versorgt), trotzdem lesen
+			temp_countErr (&oneWire.conv_err, 0xFF);
+			temp_convDone ();
+			break;
+		}
 
-			} else {
-				// CRC-Fehler
-			}
-		} else {
-			// Select fehlgeschlagen
+		// 8 Lese-Zeitschlitze, ohne Reset direkt nach CONVERT_T
+		oneWire.job_conv.flags = 0;
+		oneWire.job_conv.wr_count = 0;
+		oneWire.job_conv.rd_data = &oneWire.poll;
+		oneWire.job_conv.rd_count = 1;
+		oneWire.job_conv.done = temp_pollDone;
+
+		oneWire.state = TEMP_ST_POLL;
+		if (oneWire_submit (&oneWire.job_conv) == 0) {
+			// Warteschlange voll, beim nchsten Aufruf nochmal
+			oneWire.state = TEMP_ST_CONV;
 		}
+		break;
+
+	default:
+		// Transaktionen laufen noch
+		if (oneWire.conv_cnt < 0xFF)
+			oneWire.conv_cnt++;
+		break;
 	}
 }
 
-uint8_t temp_incrSeconds (void)
+void temp_pollDone (struct oneWire_job_s *job)
 {
-	// Sekunden inkrementieren
-	temp_hist.seconds++;
-
-	// 625 / 3 = 208 1/3 -> alle 3 Intervalle eine Sekunde zustzlich
-	temp_hist.add_sec++;
-	if (temp_hist.add_sec >= 2) {
-		temp_hist.add_sec = 0;
-		// Schaltsekunde
-		temp_hist.seconds++;
+	if (oneWire.poll != 0) {
+		// Konvertierung fertig
+		temp_convDone ();
+	} else {
+		// nchste Abfrage mit der nchsten Erfassung
+		oneWire.state = TEMP_ST_CONV;
 	}
+}
 
-	// Zeitzhler
-	if (temp_hist.seconds > 59) {
-		// Minute ist voll
-		temp_hist.seconds -= 60;
-		temp_hist.minutes++;
-	}
+void temp_convDone (void)
+{
+#if TEMP_CONV_SINGLE
+	// Konvertierungszeit des aktuellen Sensors
+	oneWire.conv_time = oneWire.conv_cnt;
 
-	if (temp_hist.minutes > 59) {
-		// Stunde ist voll
-		temp_hist.minutes = 0;
+	// Scratchpad lesen, weiter in temp_readDone
+	oneWire.state = TEMP_ST_READ;
+	temp_readDev ();
+#else
+	// alle Sensoren haben gleichzeitig konvertiert
+	oneWire.conv_time = oneWire.conv_cnt;
 
-		// Stundenzahl ist automatisch die Anzahl der auf MinMax zu prfenden Eintrge
-		// daher den 24ten Eintrag weglassen, der wird als nchstes berschrieben
-		if (temp_hist.hours < 23)
-			temp_hist.hours++;
+#if TEMP_ALARM_MODE
+	if (oneWire.alarm_cnt > 0) {
+		oneWire.alarm_cnt--;
 
-		return 1;
+		// nur Sensoren mit Alarm lesen, die sucht temp_scanStep
+		oneWire.read_mask = 0;
+		oneWire_srchInit (ONE_WIRE_CMD_ALRM_SRCH);
+		oneWire.state = TEMP_ST_ALARM;
+		return;
 	}
 
-	return 0;
+	// diesmal alle Sensoren, TH und TL werden dabei geprft
+	oneWire.alarm_cnt = TEMP_ALARM_FULL - 1;
+#endif
+
+	// alle Sensoren lesen
+	oneWire.read_mask = 0xFF;
+	temp_readFrom (0);
+#endif
 }
 
-void temp_updCurMinMax (void)
+#if TEMP_CONV_SINGLE == 0
+void temp_readFrom (uint8_t i)
 {
-	temp_val_t	tmp;
-	uint8_t		i;
-//	uint8_t		j;
-	uint8_t		id;
-
-	// aktueller Index
-	id = temp_hist.index;
-
-	for (i = 0; i < 2; i++) {
-		// nur gltige Werte verwenden
-		if (temp_hist.valid[i] != 0) {
-			// zwischenspeichern
-			tmp = temp_hist.value[i];
+	// nchsten zu lesenden Sensor suchen
+	for ( ; i < oneWire.dev_count; i++) {
+		if (oneWire.read_mask & _BV(i)) {
+			// Scratchpad lesen, weiter in temp_readDone
+			oneWire.dev = i;
+			oneWire.state = TEMP_ST_READ;
+			temp_readDev ();
+			return;
+		}
+	}
 
-			// Spitzenwertarray aktualisieren
-			if (temp_hist.min_array[i][id] > tmp)
-				temp_hist.min_array[i][id] = tmp;
+	// Runde fertig, die nchste beginnt mit der nchsten Erfassung
+	oneWire.state = TEMP_ST_IDLE;
+}
+#endif
 
-			if (temp_hist.max_array[i][id] < tmp)
-				temp_hist.max_array[i][id] = tmp;
+uint8_t temp_addrDev (void)
+{
+	// nur ein Sensor am Bus -> Adresse berspringen
+	if (oneWire.dev_count == 1) {
+		oneWire.cmd[0] = ONE_WIRE_CMD_SKIP_ROM;
+		return 1;
+	}
 
-#if 0
-			// Spitzenwerte der letzten 6, 12 und 24 Stunden
-			for (j = 0; j < 3; j++) {
-				if (temp_hist.min[i][j] > tmp)
-					temp_hist.min[i][j] = tmp;
+	// Sensor adressieren
+	oneWire.cmd[0] = ONE_WIRE_CMD_MATCH_ROM;
+	memcpy (&oneWire.cmd[1], oneWire.rom[oneWire.dev], 8);
+	return 9;
+}
 
-				if (temp_hist.max[i][j] < tmp)
-					temp_hist.max[i][j] = tmp;
-			}
+void temp_readDev (void)
+{
+	uint8_t		n;
+
+	// Sensor adressieren, Kommando: Speicher lesen
+	n = temp_addrDev ();
+	oneWire.cmd[n] = ONE_WIRE_CMD_RD_SCRATCH;
+
+	oneWire.job_read.wr_data = oneWire.cmd;
+	oneWire.job_read.wr_count = n + 1;
+	oneWire.job_read.rd_data = (uint8_t *)&oneWire.data;
+	oneWire.job_read.done = temp_readDone;
+
+#if TEMP_FAST_READ
+	if (oneWire.read_full == 0 && oneWire.fast_cnt != 0 && TEMP_VALID(oneWire.dev) != 0) {
+		// nur die Temperatur, der Rest wird durch den Reset der nchsten Transaktion abgebrochen
+		oneWire.job_read.flags = ONE_WIRE_JOB_RESET;
+		oneWire.job_read.rd_count = 2;
+	} else
 #endif
-		}
+	{
+		// 9 Byte lesen, CRC prfen
+		oneWire.job_read.flags = ONE_WIRE_JOB_RESET | ONE_WIRE_JOB_CRC;
+		oneWire.job_read.rd_count = sizeof(oneWire.data);
 	}
+	oneWire.read_full = 0;
+
+	temp_submit (&oneWire.job_read);
 }
 
-void temp_updHistMinMax (void)
+void temp_submit (struct oneWire_job_s *job)
 {
-	uint8_t		id;
-//	uint8_t		i, j;
-//	temp_val_t	min, max;
+	uint16_t	t;
 
-#if 0
-	// die beiden Sensoren einzeln auswerten
-	for (i = 0; i < 2; i++) {
+	// Busbelegung fr die Statistik
+	t = (job->wr_count + job->rd_count) * (8 * ONE_WIRE_TIME_SLOT);
+	if (job->flags & ONE_WIRE_JOB_RESET)
+		t += ONE_WIRE_TIME_RESET;
+	oneWire.read_time += t;
 
-		// mit aktuellem Index beginnen
-		id = temp_hist.index;
+	oneWire_submit (job);
+}
 
-		min = TEMP_VAL_MAX;
-		max = TEMP_VAL_MIN;
+void temp_readDone (struct oneWire_job_s *job)
+{
+	uint8_t		i, n, config, th, tl;
 
-		// Spitzenwerte der letzten Stunden (max. 23)
-		for (j = 0; j < temp_hist.hours; j++) {
-			// Minimum
-			if (min > temp_hist.min_array[i][id])
-				min = temp_hist.min_array[i][id];
-			// Maximum
-			if (max < temp_hist.max_array[i][id])
-				max = temp_hist.max_array[i][id];
+	i = oneWire.dev;
 
-			if (j < 6) {
-				// Spitzenwerte der letzten 6 Stunden
-				temp_hist.min[i][0] = min;
-				temp_hist.max[i][0] = max;
-			}
-			if (j < 12) {
-				// Spitzenwerte der letzten 12 Stunden
-				temp_hist.min[i][1] = min;
-				temp_hist.max[i][1] = max;
-			}
-			// Spitzenwerte der letzten 23 Stunden
-			temp_hist.min[i][2] = min;
-			temp_hist.max[i][2] = max;
+	// eingestellte Auflsung
+	config = (TEMP_RES_CODE(temp_ee_cfg.resolution, i) << 5) | 0x1F;
 
-			// rckwrts wandern
-			if (id > 0)
-				id--;
-			else
-				id = 23;
+#if TEMP_FAST_READ
+	if (job->status == ONE_WIRE_JOB_DONE && (job->flags & ONE_WIRE_JOB_CRC) == 0) {
+		// kurz gelesen: undefinierte Bits laut eingestellter Auflsung maskieren
+		oneWire.data.config = config;
+
+		if (temp_checkFast (i) != 0) {
+			temp_storeTemp (i);
+			temp_nextDev ();
+		} else {
+			// unplausibel -> gleich komplett mit CRC nachlesen
+			oneWire.read_full = 1;
+			temp_readDev ();
 		}
+		return;
 	}
 #endif
 
-	// neuer Index
-	id = temp_hist.index + 1;
-	// berlauf abfangen
-	if (id > 23)
-		id = 0;
+	if (job->status == ONE_WIRE_JOB_DONE) {
+		// Daten verarbeiten
+		temp_storeTemp (i);
+
+		// eingestellte Auflsung prfen, nach einem Spannungsausfall
+		// ldt der Sensor wieder die Werte aus seinem EEPROM
+#if TEMP_ALARM_MODE
+		// Schaltschwellen von Kanal 1 als Alarmgrenzen, der Sensor meldet T >= TH oder T <= TL
+		if (temp_cfg.para[CFG_PARA_CH1_ON] > temp_cfg.para[CFG_PARA_CH1_OFF]) {
+			th = temp_cfg.para[CFG_PARA_CH1_ON];
+			tl = temp_cfg.para[CFG_PARA_CH1_OFF];
+		} else {
+			th = temp_cfg.para[CFG_PARA_CH1_OFF];
+			tl = temp_cfg.para[CFG_PARA_CH1_ON];
+		}
+#else
+		// TH und TL unverndert
+		th = oneWire.data.th;
+		tl = oneWire.data.tl;
+#endif
 
-	// Index merken
-	temp_hist.index = id;
+		if (oneWire.data.config != config || oneWire.data.th != th || oneWire.data.tl != tl) {
+			// neue Schwellen und Konfigurationsregister
+			n = temp_addrDev ();
+			oneWire.cmd[n + 0] = ONE_WIRE_CMD_WR_SCRATCH;
+			oneWire.cmd[n + 1] = th;
+			oneWire.cmd[n + 2] = tl;
+			oneWire.cmd[n + 3] = config;
+
+			job->flags = ONE_WIRE_JOB_RESET;
+			job->wr_count = n + 4;
+			job->rd_count = 0;
+			job->done = temp_writeDone;
+
+			// die Kette geht in temp_writeDone weiter
+			temp_submit (job);
+			return;
+		}
+	} else {
+		// kein Presence-Pulse oder CRC-Fehler
+		temp_countErr (&oneWire.sens[i].err, (job->status == ONE_WIRE_JOB_ERR_CRC) ? TEMP_ERR_CRC : TEMP_ERR_PRES);
+
+		// Gesundheitswert verschlechtern
+		if ((oneWire.sens[i].health >> 4) < TEMP_HEALTH_MAX / TEMP_HEALTH_ERR)
+			oneWire.sens[i].health += 0x10;
+
+		if (oneWire.retry < TEMP_READ_RETRY) {
+			// gleich noch einmal komplett mit CRC lesen
+			oneWire.retry++;
+			oneWire.read_full = 1;
+			temp_readDev ();
+			return;
+		}
 
-	// neue Arraywerte zurcksetzen
-	temp_hist.min_array[0][id] = TEMP_VAL_MAX;
-	temp_hist.min_array[1][id] = TEMP_VAL_MAX;
+		// letzten gltigen Wert noch halten, die Zeit luft in temp_tickHealth
+		if ((oneWire.sens[i].health & TEMP_HEALTH_HOLD) == 0)
+			oneWire.sens[i].health++;
+		else if ((oneWire.sens[i].health & TEMP_HEALTH_HOLD) > TEMP_HOLD_S)
+			temp_hist.valid &= ~_BV(i);
+	}
 
-	temp_hist.max_array[0][id] = TEMP_VAL_MIN;
-	temp_hist.max_array[1][id] = TEMP_VAL_MIN;
+	temp_nextDev ();
 }
 
+void temp_writeDone (struct oneWire_job_s *job)
+{
+	// gilt ab der nchsten Konvertierung
+	temp_nextDev ();
+}
 
+void temp_scanStart (void)
+{
+	oneWire.scan_seen = 0;
+	oneWire.scan_new = 0;
 
+	// gezielte Suche vorbereiten, die Schritte macht temp_scanStep
+	oneWire_srchInit (ONE_WIRE_CMD_SRCH_ROM);
+	oneWire.state = TEMP_ST_SCAN;
+}
 
-void temp_updOutput (void)
+void temp_scanStep (void)
 {
-	temp_val_t	t_on, t_off, temp;
-	uint8_t		i, output[2], highOn;
+	uint8_t		dev;
 
-	for (i = 0; i < 2; i++) {
+	switch (oneWire_srchStep (ONE_WIRE_SCAN_BITS))
+	{
+	case ONE_WIRE_SRCH_FOUND:
+		// bekannter Sensor?
+		for (dev = 0; dev < oneWire.dev_count; dev++) {
+			if (memcmp (oneWire.rom[dev], oneWire.srch_rom, 8) == 0) {
+				if (oneWire.state == TEMP_ST_ALARM)
+					oneWire.read_mask |= _BV(dev);	// Alarm -> in dieser Runde lesen
+				else
+					oneWire.scan_seen |= _BV(dev);
+				return;
+			}
+		}
 
-		if (temp_hist.valid[i] != 0) {
+		// unbekannte Sensoren mit Alarm findet die nchste Hintergrundsuche
+		if (oneWire.state == TEMP_ST_ALARM)
+			break;
 
-#if TEMP_VAL_MAX > INT8_MAX
-			// Nachkommastelle hinzufgen
-			t_on  = temp_cfg.para[CFG_PARA_CH1_ON  + i] * 10;
-			t_off = temp_cfg.para[CFG_PARA_CH1_OFF + i] * 10;
-#else
+		// neuer Sensor: hinter den bekannten zwischenspeichern, zugeordnet wird am Ende
+		dev += oneWire.scan_new;
+		if (dev < ONE_WIRE_ROM_NO) {
+			memcpy (oneWire.rom[dev], oneWire.srch_rom, 8);
+			oneWire.scan_new++;
+		} else if (dev == ONE_WIRE_ROM_NO) {
+			// Tabelle voll: einer passt noch in cmd, das wird erst nach der Suche wieder
+			// gebraucht, und kann dann den Platz eines verschwundenen bernehmen (Austausch)
+			memcpy (oneWire.cmd, oneWire.srch_rom, 8);
+			oneWire.scan_new++;
+		}
+		break;
+
+	case ONE_WIRE_SRCH_END:
+		// alle Gerte der Familie durch
+#if TEMP_ALARM_MODE
+		if (oneWire.state == TEMP_ST_ALARM) {
+			// die gefundenen Sensoren lesen
+			temp_readFrom (0);
+			break;
+		}
+#endif
+		temp_scanEnd ();
+		break;
+
+	default:
+		// beim nchsten Durchlauf weiter
+		break;
+	}
+}
+
+void temp_scanEnd (void)
+{
+	uint8_t		i, dev, lost, count, *rom;
+
+	// bekannte, aber nicht mehr gefundene Sensoren
+	lost = ~oneWire.scan_seen & (uint8_t)(_BV(oneWire.dev_count) - 1);
+	count = oneWire.dev_count;
+
+	// neue Sensoren bernehmen die Pltze von verschwundenen und damit deren Rolle,
+	// die brigen werden angehngt
+	for (i = 0; i < oneWire.scan_new; i++) {
+		// zwischengespeicherte ID, der letzte bei voller Tabelle in cmd
+		if (oneWire.dev_count + i < ONE_WIRE_ROM_NO)
+			rom = oneWire.rom[oneWire.dev_count + i];
+		else
+			rom = oneWire.cmd;
+
+		for (dev = 0; dev < oneWire.dev_count; dev++) {
+			if (lost & _BV(dev))
+				break;
+		}
+
+		if (dev < oneWire.dev_count)
+			lost &= ~_BV(dev);
+		else if (count < ONE_WIRE_ROM_NO)
+			dev = count++;
+		else
+			break;		// kein Platz frei, bleibt bis zur nchsten Suche unbekannt
+
+		if (rom != oneWire.rom[dev])
+			memcpy (oneWire.rom[dev], rom, 8);
+
+		// alter Messwert, Fehlerstatistik und Kalibrierung gehren nicht zum neuen Sensor
+		temp_hist.valid &= ~_BV(dev);
+		oneWire.sens[dev].err = 0;
+		oneWire.sens[dev].health = 0;
+#if TEMP_SENSOR_CAL
+		temp_loadCal (dev, 0);
+#endif
+
+		// Versorgung und Kalibrierung fragt temp_task vor der nchsten Runde ab
+		oneWire.setup_req |= _BV(dev);
+	}
+
+	// Ergebnis fr die Anzeige
+	oneWire.scan_lost = lost;
+	oneWire.scan_slots = oneWire.srch_slots;
+
+	if (oneWire.scan_new != 0) {
+		oneWire.dev_count = count;
+
+		// fr den nchsten Start merken, Anzeigekanle neu zuordnen
+		oneWire_saveRom ();
+		temp_updRoles ();
+	}
+
+	// Bus wieder frei fr die Erfassung
+	oneWire.state = TEMP_ST_IDLE;
+}
+
+#if TEMP_BOOT_FAST || TEMP_SENSOR_CAL
+void temp_bootConfig (uint8_t dev)
+{
+	uint8_t		valid;
+
+	// Konfigurationsregister, TH und TL lesen
+	valid = oneWire_readScratch (dev);
+
+#if TEMP_SENSOR_CAL
+	temp_loadCal (dev, valid);
+#endif
+
+	if (valid == 0)
+		return;
+
+#if TEMP_BOOT_FAST
+	// 9 Bit fr die erste Konvertierung, TH und TL unverndert
+	if (oneWire.data.config != 0x1F && oneWire_selectDev (dev) != 0) {
+		oneWire_writeByte (ONE_WIRE_CMD_WR_SCRATCH);
+		oneWire_writeByte (oneWire.data.th);
+		oneWire_writeByte (oneWire.data.tl);
+		oneWire_writeByte (0x1F);
+	}
+#endif
+}
+#endif
+
+#if TEMP_SENSOR_CAL
+void temp_loadCal (uint8_t dev, uint8_t valid)
+{
+	uint8_t		i;
+
+	if (valid != 0 && (oneWire.data.th & TEMP_CAL_MAGIC_MASK) == TEMP_CAL_MAGIC) {
+		// Kalibrierung aus dem Sensor bernehmen
+		oneWire.sens[dev].cal_th = oneWire.data.th;
+		oneWire.sens[dev].cal_tl = oneWire.data.tl;
+
+		// die Rolle des Sensors ersetzt die aus dem EEPROM des AVR
+		i = TEMP_ROLE_GET(dev) ^ TEMP_CAL_ROLE(oneWire.data.th);
+		temp_ee_cfg.roles ^= (uint16_t)i << (2 * dev);
+	} else {
+		// noch nicht kalibriert: keine Korrektur, Rolle aus dem EEPROM des AVR
+		oneWire.sens[dev].cal_th = TEMP_CAL_MAGIC | TEMP_ROLE_GET(dev);
+		oneWire.sens[dev].cal_tl = 0;
+	}
+}
+
+void temp_writeCal (uint8_t dev)
+{
+	// TH und TL mit der eingestellten Auflsung ins Scratchpad, weiter in temp_copyStart
+	oneWire.dev = dev;
+	oneWire.data.th = oneWire.sens[dev].cal_th;
+	oneWire.data.tl = oneWire.sens[dev].cal_tl;
+	oneWire.data.config = (TEMP_RES_CODE(temp_ee_cfg.resolution, dev) << 5) | 0x1F;
+	temp_cmdDev (ONE_WIRE_CMD_WR_SCRATCH, ONE_WIRE_JOB_RESET, 0, temp_copyStart);
+}
+
+void temp_copyStart (struct oneWire_job_s *job)
+{
+	if (job->status != ONE_WIRE_JOB_DONE) {
+		// Sensor antwortet nicht, der Bus ist wieder frei fr die nchste Runde
+		oneWire.state = TEMP_ST_IDLE;
+		return;
+	}
+
+	// ins EEPROM des Sensors kopieren, parasitr versorgt schaltet die Engine danach den starken Pull-Up ein
+	temp_cmdDev (ONE_WIRE_CMD_CP_SCRATCH, ONE_WIRE_JOB_RESET | ((oneWire.parasite & _BV(oneWire.dev)) ? ONE_WIRE_JOB_SPU : 0), 0, 0);
+
+	// die max. 10ms wartet temp_task, weiter in temp_copyDone
+	oneWire.conv_cnt = 0;
+	oneWire.state = TEMP_ST_COPY;
+}
+
+void temp_copyDone (void)
+{
+	ONE_WIRE_SPU_OFF;
+
+	// zur Kontrolle aus dem EEPROM zurckholen, der Sensor sendet 1, wenn er fertig ist
+	oneWire.conv_cnt = 0;
+	temp_cmdDev (ONE_WIRE_CMD_RECALL_EE, ONE_WIRE_JOB_RESET, 1, temp_recallDone);
+}
+
+void temp_recallDone (struct oneWire_job_s *job)
+{
+	if (job->status == ONE_WIRE_JOB_DONE && oneWire.poll == 0 && ++oneWire.conv_cnt < TEMP_RECALL_POLL) {
+		// noch nicht fertig, weitere 8 Lese-Zeitschlitze ohne Reset
+		job->flags = 0;
+		job->wr_count = 0;
+		oneWire_submit (job);
+		return;
+	}
+
+	// angezeigt wird, was tatschlich im Sensor steht, weiter in temp_calDone
+	temp_cmdDev (ONE_WIRE_CMD_RD_SCRATCH, ONE_WIRE_JOB_RESET | ONE_WIRE_JOB_CRC, sizeof(oneWire.data), temp_calDone);
+}
+
+void temp_adjCal (uint8_t dev, int8_t step)
+{
+	int8_t		val;
+
+	if (menu_cfg.cal == 0) {
+		// Offset in 1/16 C, berlauf abfangen
+		val = (int8_t)oneWire.sens[dev].cal_tl;
+		if ((step > 0 && val < INT8_MAX) || (step < 0 && val > INT8_MIN))
+			oneWire.sens[dev].cal_tl = val + step;
+	} else {
+		// Verstrkung -4...+3 in 1/128
+		val = TEMP_CAL_GAIN(oneWire.sens[dev].cal_th) + step;
+		if (val >= -4 && val <= 3)
+			oneWire.sens[dev].cal_th = TEMP_CAL_GAIN_SET(oneWire.sens[dev].cal_th, val);
+	}
+}
+#endif
+
+void temp_checkSupply (uint8_t dev)
+{
+	oneWire.parasite &= ~_BV(dev);
+
+	// READ POWER SUPPLY: ein parasitr versorgter Sensor zieht den folgenden Zeitschlitz auf 0
+	if (oneWire_selectDev (dev) != 0) {
+		oneWire_writeByte (ONE_WIRE_RD_SUPPLY);
+
+		if (oneWire_readBit () == 0)
+			oneWire.parasite |= _BV(dev);
+	}
+}
+
+void temp_cmdDev (uint8_t cmd, uint8_t flags, uint8_t rd_count, void (*done)(struct oneWire_job_s *job))
+{
+	uint8_t		n;
+
+	// Sensor oneWire.dev adressieren, Kommando
+	n = temp_addrDev ();
+	oneWire.cmd[n++] = cmd;
+
+	// WRITE SCRATCHPAD: TH, TL und Konfigurationsregister aus oneWire.data
+	if (cmd == ONE_WIRE_CMD_WR_SCRATCH) {
+		memcpy (&oneWire.cmd[n], &oneWire.data.th, 3);
+		n += 3;
+	}
+
+	oneWire.job_read.flags = flags;
+	oneWire.job_read.wr_data = oneWire.cmd;
+	oneWire.job_read.wr_count = n;
+
+	// ein Statusbyte nach poll oder das ganze Scratchpad
+	oneWire.job_read.rd_count = rd_count;
+	if (rd_count == sizeof(oneWire.data))
+		oneWire.job_read.rd_data = (uint8_t *)&oneWire.data;
+	else
+		oneWire.job_read.rd_data = &oneWire.poll;
+	oneWire.job_read.done = done;
+
+	// der Bus gehrt bis zum Ende der Kette diesem Sensor
+	oneWire.state = TEMP_ST_SETUP;
+	oneWire_submit (&oneWire.job_read);
+}
+
+void temp_setupDev (uint8_t dev)
+{
+	// READ POWER SUPPLY, weiter in temp_supplyDone
+	oneWire.dev = dev;
+	temp_cmdDev (ONE_WIRE_RD_SUPPLY, ONE_WIRE_JOB_RESET, 1, temp_supplyDone);
+}
+
+void temp_supplyDone (struct oneWire_job_s *job)
+{
+	// ein parasitr versorgter Sensor zieht den ersten Zeitschlitz auf 0
+	oneWire.parasite &= ~_BV(oneWire.dev);
+	if (job->status == ONE_WIRE_JOB_DONE && (oneWire.poll & 0x01) == 0)
+		oneWire.parasite |= _BV(oneWire.dev);
+
+#if TEMP_SENSOR_CAL
+	// Kalibrierung aus dem Sensor holen, weiter in temp_calDone
+	if (job->status == ONE_WIRE_JOB_DONE) {
+		temp_cmdDev (ONE_WIRE_CMD_RD_SCRATCH, ONE_WIRE_JOB_RESET | ONE_WIRE_JOB_CRC, sizeof(oneWire.data), temp_calDone);
+		return;
+	}
+#endif
+
+	// Auflsung und Schwellen stellt temp_readDone in der nchsten Runde ein
+	oneWire.state = TEMP_ST_IDLE;
+}
+
+#if TEMP_SENSOR_CAL
+void temp_calDone (struct oneWire_job_s *job)
+{
+	// bernommen wird nur, was tatschlich im Sensor steht, die unteren 5 Bit im Konfigurationsregister sind immer 1
+	if (job->status == ONE_WIRE_JOB_DONE && (oneWire.data.config & 0x9F) == 0x1F)
+		temp_loadCal (oneWire.dev, 1);
+
+	oneWire.state = TEMP_ST_IDLE;
+}
+#endif
+
+void temp_nextDev (void)
+{
+	uint8_t		i;
+
+	i = oneWire.dev;
+
+	// der nchste Sensor hat wieder alle Wiederholungen
+	oneWire.retry = 0;
+
+#if TEMP_CONV_SINGLE
+	// alle gefundenen Sensoren einlesen und speichern
+	if (++i < oneWire.dev_count) {
+		oneWire.dev = i;
+		// nchsten Sensor konvertieren
+		temp_startTemp ();
+	} else {
+		// Runde fertig, die nchste beginnt mit der nchsten Erfassung
+		oneWire.state = TEMP_ST_IDLE;
+	}
+#else
+	// nchsten Sensor lesen
+	temp_readFrom (i + 1);
+#endif
+}
+
+#if TEMP_FAST_READ
+uint8_t temp_checkFast (uint8_t i)
+{
+	temp_val_t	temp;
+
+	// Bit 11 bis 15 sind Vorzeichenbits, 85 C ist der Einschaltwert nach einem Reset des Sensors
+	if (   ((oneWire.data.temp_hi & 0xF8) != 0 && (oneWire.data.temp_hi & 0xF8) != 0xF8)
+		|| (oneWire.data.temp_hi == 0x05 && oneWire.data.temp_lo == 0x50))
+		return 0;
+
+	// Sprung gegenber dem letzten Wert, Messwerte in 0,1 C bzw. 1 C
+	temp = temp_convert (i) - temp_hist.value[i];
+	if (temp > TEMP_FAST_JUMP * TEMP_KTY_UNIT / 10 || temp < -(TEMP_FAST_JUMP * TEMP_KTY_UNIT / 10))
+		return 0;
+
+	return 1;
+}
+#endif
+
+void temp_storeTemp (uint8_t i)
+{
+	// aktuellen Wert speichern
+	temp_hist.value[i] = temp_convert (i);
+
+#if BOOT_TIME_PROBE
+	// erster gltiger Messwert
+	PORTC |= _BV(PC0);
+#endif
+
+	// Wert ist gltig
+	temp_hist.valid |= _BV(i);
+	oneWire.sens[i].health &= ~TEMP_HEALTH_HOLD;
+}
+
+void temp_countErr (uint8_t *cnt, uint8_t mask)
+{
+	// Zhler in den Bits von mask, bleibt beim Maximum stehen
+	if ((*cnt & mask) != mask)
+		*cnt += mask & -mask;
+}
+
+void temp_tickHealth (void)
+{
+	uint8_t		i;
+
+	for (i = 0; i < oneWire.dev_count; i++) {
+		if ((oneWire.sens[i].health & TEMP_HEALTH_HOLD) == 0) {
+			// Gesundheitswert erholt sich, solange der Sensor gltig gelesen wird
+			if (oneWire.sens[i].health >= 0x10)
+				oneWire.sens[i].health -= 0x10;
+		} else if ((oneWire.sens[i].health & TEMP_HEALTH_HOLD) != TEMP_HEALTH_HOLD) {
+			// Haltezeit seit dem ersten Fehlschlag
+			oneWire.sens[i].health++;
+		}
+	}
+}
+
+temp_val_t temp_convert (uint8_t i)
+{
+	int16_t		temp;
+
+	// 2 Byte zusammenfhren
+	temp = (oneWire.data.temp_hi << 8) | oneWire.data.temp_lo;
+
+	// bei 9 bis 11 Bit Auflsung sind die unteren 3 bis 1 Bits undefiniert
+	temp &= ~((1 << (3 - ((oneWire.data.config >> 5) & 0x03))) - 1);
+
+#if TEMP_SENSOR_CAL
+	// Kalibrierung des Sensors in 1/16 C: erst die Verstrkung in 1/128, dann der Offset
+	temp += (temp * TEMP_CAL_GAIN(oneWire.sens[i].cal_th)) >> 7;
+	temp += (int8_t)oneWire.sens[i].cal_tl;
+#endif
+
+	// 1 Bit entspricht 0.0625 C = 1 / 16 C
+#if TEMP_VAL_MAX > INT8_MAX
+	// mal (0.0625 * 10) => mal 10 durch 16
+	temp *= 10;
+	temp >>= 4;	// /= 16;
+#else
+	// Das wirft die Nachkommastellen weg, und es reicht int8!
+	temp /= 16;
+#endif
+
+	return temp;
+}
+
+void temp_evaluate (void)
+{
+#if ONE_WIRE_ENABLE
+	// Spitzenwerte aktualisieren
+	temp_updCurMinMax ();
+#endif
+
+	// Sekunden inkrementieren, liefert 1 wenn eine Stunde voll ist
+	if (temp_incrSeconds() != 0) {
+		// MinMax-Werte der letzten Stunden aktualisieren
+		temp_updHistMinMax ();
+	}
+
+	// Messwerte ausgeben, wenn nicht gerade beim Einstellen
+	if (   menu_cfg.menu < MENU_EDIT_CH1_ON
+		|| menu_cfg.menu > MENU_EDIT_LAST)
+	{
+		// Werte vergleichen, Ausgnge schalten
+		temp_updOutput ();
+	}
+}
+
+uint8_t temp_incrSeconds (void)
+{
+	// Sekunden inkrementieren
+	temp_hist.seconds++;
+
+	// 625 / 3 = 208 1/3 -> alle 3 Intervalle eine Sekunde zustzlich
+	temp_hist.add_sec++;
+	if (temp_hist.add_sec >= 2) {
+		temp_hist.add_sec = 0;
+		// Schaltsekunde
+		temp_hist.seconds++;
+	}
+
+	// Zeitzhler
+	if (temp_hist.seconds > 59) {
+		// Minute ist voll
+		temp_hist.seconds -= 60;
+		temp_hist.minutes++;
+	}
+
+	if (temp_hist.minutes > 59) {
+		// Stunde ist voll
+		temp_hist.minutes = 0;
+
+		// Stundenzahl ist automatisch die Anzahl der auf MinMax zu prfenden Eintrge
+		// daher den 24ten Eintrag weglassen, der wird als nchstes berschrieben
+		if (temp_hist.hours < 23)
+			temp_hist.hours++;
+
+		return 1;
+	}
+
+	return 0;
+}
+
+void temp_updCurMinMax (void)
+{
+	temp_hist_t	tmp;
+	uint8_t		i, dev;
+//	uint8_t		j;
+	uint8_t		id;
+
+	// aktueller Index
+	id = temp_hist.index;
+
+	for (i = 0; i < TEMP_HIST_CH_NO; i++) {
+		dev = temp_hist.chan[i];
+
+		// nur gltige Werte verwenden
+		if (dev < ONE_WIRE_DEV_NO && TEMP_VALID(dev) != 0) {
+			// fr den Verlauf umrechnen
+			tmp = temp_histVal (temp_hist.value[dev]);
+
+			// Spitzenwertarray aktualisieren
+			if (temp_hist.min_array[i][id] > tmp)
+				temp_hist.min_array[i][id] = tmp;
+
+			if (temp_hist.max_array[i][id] < tmp)
+				temp_hist.max_array[i][id] = tmp;
+
+#if 0
+			// Spitzenwerte der letzten 6, 12 und 24 Stunden
+			for (j = 0; j < 3; j++) {
+				if (temp_hist.min[i][j] > tmp)
+					temp_hist.min[i][j] = tmp;
+
+				if (temp_hist.max[i][j] < tmp)
+					temp_hist.max[i][j] = tmp;
+			}
+#endif
+		}
+	}
+}
+
+temp_hist_t temp_histVal (temp_val_t value)
+{
+#if TEMP_VAL_MAX > INT8_MAX
+	// 0.1 C -> 0.5 C gerundet
+	if (value >= 0)
+		value = (value + 2) / 5;
+	else
+		value = (value - 2) / 5;
+
+	// begrenzen, die Grenzwerte sind die Startwerte fr Min/Max
+	if (value > TEMP_HIST_MAX - 1)
+		value = TEMP_HIST_MAX - 1;
+	else if (value < TEMP_HIST_MIN + 1)
+		value = TEMP_HIST_MIN + 1;
+#endif
+
+	return value;
+}
+
+void temp_updHistMinMax (void)
+{
+	uint8_t		i, id;
+//	uint8_t		j;
+//	temp_val_t	min, max;
+
+#if 0
+	// die beiden Sensoren einzeln auswerten
+	for (i = 0; i < 2; i++) {
+
+		// mit aktuellem Index beginnen
+		id = temp_hist.index;
+
+		min = TEMP_VAL_MAX;
+		max = TEMP_VAL_MIN;
+
+		// Spitzenwerte der letzten Stunden (max. 23)
+		for (j = 0; j < temp_hist.hours; j++) {
+			// Minimum
+			if (min > temp_hist.min_array[i][id])
+				min = temp_hist.min_array[i][id];
+			// Maximum
+			if (max < temp_hist.max_array[i][id])
+				max = temp_hist.max_array[i][id];
+
+			if (j < 6) {
+				// Spitzenwerte der letzten 6 Stunden
+				temp_hist.min[i][0] = min;
+				temp_hist.max[i][0] = max;
+			}
+			if (j < 12) {
+				// Spitzenwerte der letzten 12 Stunden
+				temp_hist.min[i][1] = min;
+				temp_hist.max[i][1] = max;
+			}
+			// Spitzenwerte der letzten 23 Stunden
+			temp_hist.min[i][2] = min;
+			temp_hist.max[i][2] = max;
+
+			// rckwrts wandern
+			if (id > 0)
+				id--;
+			else
+				id = 23;
+		}
+	}
+#endif
+
+	// neuer Index
+	id = temp_hist.index + 1;
+	// berlauf abfangen
+	if (id > 23)
+		id = 0;
+
+	// Index merken
+	temp_hist.index = id;
+
+	// neue Arraywerte zurcksetzen
+	for (i = 0; i < TEMP_HIST_CH_NO; i++) {
+		temp_hist.min_array[i][id] = TEMP_HIST_MAX;
+		temp_hist.max_array[i][id] = TEMP_HIST_MIN;
+	}
+}
+
+#if TEMP_KTY_CH || !ONE_WIRE_ENABLE
+temp_val_t temp_ktyConv (uint16_t adc)
+{
+	uint8_t		i;
+	uint16_t	a0;
+
+	// auerhalb der Kennlinie: Kurzschluss, Unterbrechung oder falscher Sensor
+	if (adc < pgm_read_word(&temp_kty_tab[0].adc)
+		|| adc >= pgm_read_word(&temp_kty_tab[TEMP_KTY_TAB_NO - 1].adc))
+		return TEMP_VAL_MIN;
+
+	// Abschnitt suchen, die Kennlinie steigt
+	i = TEMP_KTY_TAB_NO - 2;
+	while (adc < (a0 = pgm_read_word(&temp_kty_tab[i].adc)))
+		i--;
+
+	// interpolieren, (adc - a0) * slope bleibt unter 10 * TEMP_KTY_UNIT * 256
+	return (TEMP_KTY_T_MIN + 10 * i) * TEMP_KTY_UNIT
+		+ (temp_val_t)(((adc - a0) * pgm_read_word(&temp_kty_tab[i].slope)) >> 8);
+}
+#endif
+
+#if TEMP_KTY_CH
+void temp_ktyTask (void)
+{
+	uint8_t		k, dev;
+	temp_val_t	temp;
+
+	// jede Erfassung summieren
+	for (k = 0; k < TEMP_HIST_CH_NO; k++) {
+		if (TEMP_KTY_CH & _BV(k))
+			temp_kty.sum[k] += adc_data.mem[k - ADMUX_MIN];
+	}
+
+	if (++temp_kty.cnt < (1 << (2 * TEMP_KTY_OVS_BITS)))
+		return;
+	temp_kty.cnt = 0;
+
+	for (k = 0; k < TEMP_HIST_CH_NO; k++) {
+		if ((TEMP_KTY_CH & _BV(k)) == 0)
+			continue;
+
+		// dezimieren, bleibt bis zur nchsten Summe stehen
+		dev = TEMP_KTY_DEV(k);
+		temp = temp_ktyConv (temp_kty.sum[k] >> TEMP_KTY_OVS_BITS);
+		temp_kty.sum[k] = 0;
+
+		if (temp == TEMP_VAL_MIN) {
+			temp_hist.valid &= ~_BV(dev);
+		} else {
+			temp_hist.value[dev] = temp;
+			temp_hist.valid |= _BV(dev);
+		}
+	}
+}
+#endif
+
+void temp_updRoles (void)
+{
+	uint8_t		i, dev;
+
+	// Anzeigekanal 1 zeigt den ersten Sensor an der Decke, Kanal 2 den ersten am Boden
+	for (i = 0; i < TEMP_HIST_CH_NO; i++) {
+#if TEMP_KTY_CH
+		// Kanal mit KTY
+		if (TEMP_KTY_CH & _BV(i)) {
+			temp_hist.chan[i] = TEMP_KTY_DEV(i);
+			continue;
+		}
+#endif
+		temp_hist.chan[i] = 0xFF;
+
+		for (dev = 0; dev < oneWire.dev_count; dev++) {
+			if (TEMP_ROLE_GET(dev) == TEMP_ROLE_CEILING + i) {
+				temp_hist.chan[i] = dev;
+				break;
+			}
+		}
+	}
+
+	// Zuordnung gendert, zwischengespeicherte Anzeigezeilen verwerfen
+	menu_cfg.changed |= MENU_CHG_FULL;
+}
+
+
+
+
+void temp_updOutput (void)
+{
+	temp_val_t	t_on, t_off, temp, min, max;
+	uint8_t		i, dev, src, ok, output[2], highOn, role;
+
+	for (i = 0; i < 2; i++) {
+
+		// Quellenauswahl
+		src = OUTPUT_CHx_SRC(i);
+
+		// grten und kleinsten Wert aller Sensoren mit passender Rolle suchen,
+		// ausgefallene Sensoren werden bergangen, die brigen bernehmen
+		min = TEMP_VAL_MAX;
+		max = TEMP_VAL_MIN;
+		ok = 0;
+
+		for (dev = 0; dev < ONE_WIRE_DEV_NO; dev++) {
+			if (dev < oneWire.dev_count)
+				role = TEMP_ROLE_GET(dev);
+#if TEMP_KTY_CH
+			else if (TEMP_KTY_IS(dev))
+				role = TEMP_ROLE_CEILING + (ONE_WIRE_DEV_NO - 1 - dev);
+#endif
+			else
+				continue;
+
+			if ((src & TEMP_SRC_ROLE(role)) == 0 || TEMP_VALID(dev) == 0)
+				continue;
+
+			if (min > temp_hist.value[dev])
+				min = temp_hist.value[dev];
+			if (max < temp_hist.value[dev])
+				max = temp_hist.value[dev];
+			ok++;
+		}
+
+		// fr die Differenz braucht es mindestens zwei Sensoren
+		if (src & TEMP_SRC_SPREAD)
+			ok >>= 1;
+
+		if (ok != 0) {
+
+#if TEMP_VAL_MAX > INT8_MAX
+			// Nachkommastelle hinzufgen
+			t_on  = temp_cfg.para[CFG_PARA_CH1_ON  + i] * 10;
+			t_off = temp_cfg.para[CFG_PARA_CH1_OFF + i] * 10;
+#else
 			t_on  = temp_cfg.para[CFG_PARA_CH1_ON  + i];
 			t_off = temp_cfg.para[CFG_PARA_CH1_OFF + i];
 #endif
 
-			// das Ergebnis des Vergleichs braucht man mehrmals
-			highOn = (t_on > t_off);
+			// das Ergebnis des Vergleichs braucht man mehrmals
+			highOn = (t_on > t_off);
+
+			if (src & TEMP_SRC_SPREAD) {
+				// Kanal abhngig von der absoluten Temperaturdifferenz
+				temp = max - min;
+			} else if (highOn != 0) {
+				// ON bei hohen Temperaturen, OFF bei niedrigeren
+				// den grten der Werte
+				temp = max;
+			} else {
+				// ON bei niedrigen Temperaturen, OFF bei hheren
+				// den kleinsten der Werte
+				temp = min;
+			}
+
+			// vergleichen
+			if (highOn != 0) {
+				// ON bei hohen Temperaturen, OFF bei niedrigeren
+				if (temp >= t_on) {
+					// CHx an
+					output[i] = 1;
+
+				} else if (temp <= t_off) {
+					// CHx aus
+					output[i] = 0;
+
+				} else {
+					// noch keine nderung, alter Wert bleibt erhalten
+					output[i] = output_data.current[i];
+				}
+			} else {
+				// ON bei niedrigen Temperaturen, OFF bei hheren
+				if (temp <= t_on) {
+					// CHx an
+					output[i] = 1;
+
+				} else if (temp >= t_off) {
+					// CHx aus
+					output[i] = 0;
+
+				} else {
+					// noch keine nderung, alter Wert bleibt erhalten
+					output[i] = output_data.current[i];
+				}
+			}
+		} else {
+			// keine gltigen Daten vom Sensor -> ausschalten
+			output[i] = 0;
+		}
+	}
+
+	// Kanal 2 erhlt als Eingangssignal die Veroderung aus Kanal 2 und T2 von Kanal 1
+	output[1] |= output_data.reg2[0];
+
+	// Verzgerungen berechnen
+	for (i = 0; i < 2; i++) {
+		// an oder aus -> vergleichen mit dem aktuellen Zustand
+		if (output_data.current[i] != output[i]) {
+			// neuen Zustand speichern
+			output_data.current[i] = output[i];
+			// Zhler zurcksetzen
+			output_data.count[i] = 0;
+
+		} else {
+			// Zustand bleibt gleich
+			if (output_data.count[i] < 0xFF)
+				output_data.count[i] += 1;
+
+			// Verzgerung 1 prfen
+			if (output_data.count[i] >= (TEMP_OUTPUT_1_COUNT - 1)) {
+				// ins Ausgangregister bernehmen
+				output_data.reg1[i] = output[i];
+			}
+
+			// Verzgerung 2 prfen
+			if (output_data.count[i] >= (TEMP_OUTPUT_2_COUNT - 1)) {
+				// ins Ausgangregister bernehmen
+				output_data.reg2[i] = output[i];
+			}
+		}
+	}
+
+
+	// einzeln ins Ausgangsregister schreiben
+	// jeweils die um T1 verzgerten Zustnde
+	if (output_data.reg1[0] != 0)
+		OUTPUT_CHx_REG |=  OUTPUT_CHx_BIT(0);
+	else
+		OUTPUT_CHx_REG &= ~OUTPUT_CHx_BIT(0);
+
+	if (output_data.reg1[1] != 0)
+		OUTPUT_CHx_REG |=  OUTPUT_CHx_BIT(1);
+	else
+		OUTPUT_CHx_REG &= ~OUTPUT_CHx_BIT(1);
+}
+
+
+#if ONE_WIRE_ENABLE
+/*
+ * Lese-/Schreib-Funktionen nach MAXIM Application Note 126:
+ * "1-Wire Communication Through Software"
+ *
+ * Suchalgorithmus nach MAXIM Application Note 187:
+ * "1-Wire Search Algorithm"
+ *
+ * Kommunikation mit DS18B20 laut Datenblatt
+ */
+
+#if ONE_WIRE_USART
+/*
+ * Ein Zeitschlitz ist ein UART-Zeichen: das Startbit ist der Low-Puls des
+ * Masters, das Echo auf RXD zeigt, ob ein Slave den Bus low gehalten hat.
+ * Die Zeiten kommen aus dem Baudratengenerator, Interrupte stren nicht.
+ */
+uint8_t oneWire_usartSlot (uint8_t data)
+{
+	// senden und auf das Echo warten
+	UDR0 = data;
+	while ((UCSR0A & _BV(RXC0)) == 0)
+		;
+
+	return UDR0;
+}
+
+uint8_t oneWire_reset (void)
+{
+	uint8_t		result;
+
+	// 0xF0 mit 9600 Baud: ca. 520s low, der Presence-Pulse zieht die oberen Bits auf 0
+	UBRR0 = ONE_WIRE_UBRR_RESET;
+	result = oneWire_usartSlot (0xF0);
+	UBRR0 = ONE_WIRE_UBRR_SLOT;
+
+	// return 1 if the echo was changed -> device present
+	return (result != 0xF0);
+}
+
+void oneWire_writeBit (uint8_t data)
+{
+	// 0xFF: nur das Startbit ist low, 0x00: ca. 78s low
+	oneWire_usartSlot ((data != 0) ? 0xFF : 0x00);
+}
+
+uint8_t oneWire_readBit (void)
+{
+	// return 1 if no slave pulled the bus low
+	return (oneWire_usartSlot (0xFF) == 0xFF);
+}
+#else
+uint8_t oneWire_reset (void)
+{
+	uint8_t		result;
+
+	ONE_WIRE_DELAY_G;
+
+	// drive DQ low
+	ONE_WIRE_OUT_LO;
+	ONE_WIRE_DELAY_H;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// release the bus
+		ONE_WIRE_RELEASE;
+		ONE_WIRE_DELAY_I;
+
+		// sample for presence pulse from slave
+		result = ONE_WIRE_READ;
+	}
+
+	// complete the reset sequence recovery
+	ONE_WIRE_DELAY_J;
+
+	// return 1 if presence pulse was 0 -> device present
+	return (result == 0);
+}
+
+void oneWire_writeBit (uint8_t data)
+{
+	if (data != 0)
+	{
+		// write '1' bit
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			// drive DQ low
+			ONE_WIRE_OUT;
+			ONE_WIRE_DELAY_A;
+
+			// release the bus
+			ONE_WIRE_RELEASE;
+		}
+
+		// complete the time slot and 10us recovery
+		ONE_WIRE_DELAY_B;
+	}
+	else
+	{
+		// write '0' bit
+		// drive DQ low
+		ONE_WIRE_OUT;
+		ONE_WIRE_DELAY_C;
+
+		// release the bus
+		ONE_WIRE_RELEASE;
+		ONE_WIRE_DELAY_D;
+	}
+}
+
+void oneWire_writeByte (uint8_t data)
+{
+	// loop to write each bit in the byte, LSB first
+	for (uint8_t i = 0; i < 8; i++) {
+		// write the LSB
+		oneWire_writeBit (data & 0x01);
+
+		// shift the data byte for the next bit
+		data >>= 1;
+	}
+}
+
+uint8_t oneWire_readBit (void)
+{
+	uint8_t		result;
 
-			// Quellenauswahl
-			switch (OUTPUT_CHx_SRC(i))
-			{
-			case TEMP_SRC_0:
-				// Kanal abhngig vom Wert der definierten Quelle
-				temp = temp_hist.value[0];
-				break;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// drive DQ low
+		ONE_WIRE_OUT;
+		ONE_WIRE_DELAY_A;
 
-			case TEMP_SRC_1:
-				// Kanal abhngig vom Wert der definierten Quelle
-				temp = temp_hist.value[1];
-				break;
+		// release the bus
+		ONE_WIRE_RELEASE;
+		ONE_WIRE_DELAY_E;
 
-			default:
-			case TEMP_SRC_0_OR_1:
-				// Quellenauswahl abghngig von den Parametern
-				if (highOn != 0) {
-					// ON bei hohen Temperaturen, OFF bei niedrigeren
-					// den greren der beiden Werte
-					if (temp_hist.value[0] > temp_hist.value[1])
-						temp = temp_hist.value[0];
-					else
-						temp = temp_hist.value[1];
-				} else {
-					// ON bei niedrigen Temperaturen, OFF bei hheren
-					// den kleineren der beiden Werte
-					if (temp_hist.value[0] < temp_hist.value[1])
-						temp = temp_hist.value[0];
-					else
-						temp = temp_hist.value[1];
-				}
-				break;
+		// sample the bit value
+		result = ONE_WIRE_READ;
+	}
 
-			case TEMP_SRC_DELTA:
-				// Kanal abhngig von der absoluten Temperaturdifferenz
-				temp = temp_hist.value[0] - temp_hist.value[1];
-				if (temp < 0)
-					temp *= -1;
-				break;
-			}
+	// complete the time slot and 10us recovery
+	ONE_WIRE_DELAY_F;
 
-			// vergleichen
-			if (highOn != 0) {
-				// ON bei hohen Temperaturen, OFF bei niedrigeren
-				if (temp >= t_on) {
-					// CHx an
-					output[i] = 1;
+	// return 1 if the sampled value was 1
+	return (result != 0);
+}
+#endif	// ONE_WIRE_USART
 
-				} else if (temp <= t_off) {
-					// CHx aus
-					output[i] = 0;
+uint8_t oneWire_readByte (void)
+{
+	uint8_t		result;
 
-				} else {
-					// noch keine nderung, alter Wert bleibt erhalten
-					output[i] = output_data.current[i];
-				}
-			} else {
-				// ON bei niedrigen Temperaturen, OFF bei hheren
-				if (temp <= t_on) {
-					// CHx an
-					output[i] = 1;
+	result = 0;
 
-				} else if (temp >= t_off) {
-					// CHx aus
-					output[i] = 0;
+	for (uint8_t i = 0; i < 8; i++) {
+		// shift the result to get it ready for the next bit
+		result >>= 1;
 
-				} else {
-					// noch keine nderung, alter Wert bleibt erhalten
-					output[i] = output_data.current[i];
-				}
-			}
-		} else {
-			// keine gltigen Daten vom Sensor -> ausschalten
-			output[i] = 0;
+		// if sampled bit value is 1, then set MSB
+		if (oneWire_readBit())
+			result |= 0x80;
+	}
+
+	return result;
+}
+
+uint8_t oneWire_findFirst (void)
+{
+	oneWire.dev_count = 0;
+
+	// gezielte Suche vorbereiten
+	oneWire_srchInit (ONE_WIRE_CMD_SRCH_ROM);
+
+	return oneWire_search ();
+}
+
+uint8_t oneWire_findNext (void)
+{
+	return oneWire_search ();
+}
+
+uint8_t oneWire_search (void)
+{
+	uint8_t		result;
+
+	// exit if ROM buffer is full
+	if (oneWire.dev_count >= ONE_WIRE_ROM_NO)
+		return 0;
+
+	// die ganze ID am Stck suchen
+	do {
+		result = oneWire_srchStep (64);
+	} while (result == ONE_WIRE_SRCH_BUSY);
+
+	if (result != ONE_WIRE_SRCH_FOUND)
+		return 0;
+
+	// next device
+	memcpy (oneWire.rom[oneWire.dev_count], oneWire.srch_rom, 8);
+	oneWire.dev_count++;
+
+	return 1;
+}
+
+void oneWire_srchInit (uint8_t cmd)
+{
+	// normale Suche oder nur Gerte mit Alarm
+	oneWire.srch_cmd = cmd;
+
+	// Target Setup laut AppNote 187: die Suche beginnt bei der gewnschten Familie
+	memset (oneWire.srch_rom, 0, 8);
+	oneWire.srch_rom[0] = ONE_WIRE_FAMILY;
+
+	oneWire.last_disc = 64;
+	oneWire.last_fam_disc = 0;
+	oneWire.last_device = 0;
+
+	oneWire.srch_bit = 0;
+	oneWire.srch_slots = 0;
+}
+
+uint8_t oneWire_srchStep (uint8_t bits)
+{
+	uint8_t		id_bit, id_bit_cmp;
+	uint8_t		rom_byte_no, rom_byte_mask, direction;
+
+	if (oneWire.srch_bit == 0) {
+		// der letzte Durchlauf hat das letzte Gert gefunden
+		if (oneWire.last_device != 0)
+			return ONE_WIRE_SRCH_END;
+
+		// 1-Wire reset
+		if (oneWire_reset() == 0) {
+			// reset the search
+			oneWire.last_disc = 0;
+			oneWire.last_fam_disc = 0;
+			return ONE_WIRE_SRCH_END;
 		}
+
+		// issue the search command
+		oneWire_writeByte (oneWire.srch_cmd);
+		oneWire.srch_slots += 8;
+
+		// initialize for search
+		oneWire.srch_bit = 1;
+		oneWire.srch_zero = 0;
+		oneWire.crc8 = 0;
 	}
 
-	// Kanal 2 erhlt als Eingangssignal die Veroderung aus Kanal 2 und T2 von Kanal 1
-	output[1] |= output_data.reg2[0];
+	// die gewnschte Anzahl Bits abarbeiten
+	while (bits-- > 0) {
+		rom_byte_no = (oneWire.srch_bit - 1) >> 3;
+		rom_byte_mask = _BV((oneWire.srch_bit - 1) & 0x07);
 
-	// Verzgerungen berechnen
-	for (i = 0; i < 2; i++) {
-		// an oder aus -> vergleichen mit dem aktuellen Zustand
-		if (output_data.current[i] != output[i]) {
-			// neuen Zustand speichern
-			output_data.current[i] = output[i];
-			// Zhler zurcksetzen
-			output_data.count[i] = 0;
+		// read the bit and its complement
+		id_bit = oneWire_readBit ();
+		id_bit_cmp = oneWire_readBit ();
+		oneWire.srch_slots += 3;
+
+		// check for no device on 1-Wire
+		if (id_bit != 0 && id_bit_cmp != 0) {
+			// no device responded, reset the search
+			oneWire.srch_bit = 0;
+			oneWire.last_disc = 0;
+			oneWire.last_fam_disc = 0;
+			return ONE_WIRE_SRCH_END;
+		}
 
+		// all devices coupled have 0 or 1
+		if (id_bit != id_bit_cmp) {
+			// bit write value for search
+			direction = (id_bit != 0);
 		} else {
-			// Zustand bleibt gleich
-			if (output_data.count[i] < 0xFF)
-				output_data.count[i] += 1;
+			// if this discrepancy is before the last discrepancy
+			// on a previous next then pick the same as last time
+			if (oneWire.srch_bit < oneWire.last_disc)
+				direction = ((oneWire.srch_rom[rom_byte_no] & rom_byte_mask) != 0);
+			else
+				// if equal to last pick 1, if not then pick 0
+				direction = (oneWire.srch_bit == oneWire.last_disc);
 
-			// Verzgerung 1 prfen
-			if (output_data.count[i] >= (TEMP_OUTPUT_1_COUNT - 1)) {
-				// ins Ausgangregister bernehmen
-				output_data.reg1[i] = output[i];
+			// if 0 was picked then record its position
+			if (direction == 0) {
+				oneWire.srch_zero = oneWire.srch_bit;
+
+				// check for last discrepancy in family
+				if (oneWire.srch_zero < 9)
+					oneWire.last_fam_disc = oneWire.srch_zero;
 			}
+		}
 
-			// Verzgerung 2 prfen
-			if (output_data.count[i] >= (TEMP_OUTPUT_2_COUNT - 1)) {
-				// ins Ausgangregister bernehmen
-				output_data.reg2[i] = output[i];
+		// set or clear the bit in the ROM byte rom_byte_no with mask rom_byte_mask
+		if (direction != 0)
+			oneWire.srch_rom[rom_byte_no] |=  rom_byte_mask;
+		else
+			oneWire.srch_rom[rom_byte_no] &= ~rom_byte_mask;
+
+		// serial number search direction write bit
+		oneWire_writeBit (direction);
+
+		// ROM-Byte komplett
+		if (rom_byte_mask == 0x80)
+			oneWire_updateCRC (oneWire.srch_rom[rom_byte_no]);
+
+		// alle 64 Bits durch
+		if (++oneWire.srch_bit > 64) {
+			oneWire.srch_bit = 0;
+
+			// CRC falsch, oder eine andere Familie -> die gewnschte ist komplett
+			if (oneWire.crc8 != 0 || oneWire.srch_rom[0] != ONE_WIRE_FAMILY) {
+				oneWire.last_disc = 0;
+				oneWire.last_fam_disc = 0;
+				oneWire.last_device = 1;
+				return ONE_WIRE_SRCH_END;
 			}
+
+			// search successful so set last_disc, last_device
+			oneWire.last_disc = oneWire.srch_zero;
+
+			// check for last device
+			if (oneWire.last_disc == 0)
+				oneWire.last_device = 1;
+
+			return ONE_WIRE_SRCH_FOUND;
 		}
 	}
 
+	// beim nchsten Aufruf weiter
+	return ONE_WIRE_SRCH_BUSY;
+}
 
-	// einzeln ins Ausgangsregister schreiben
-	// jeweils die um T1 verzgerten Zustnde
-	if (output_data.reg1[0] != 0)
-		OUTPUT_CHx_REG |=  OUTPUT_CHx_BIT(0);
-	else
-		OUTPUT_CHx_REG &= ~OUTPUT_CHx_BIT(0);
+uint8_t oneWire_selectDev (uint8_t dev)
+{
+	uint8_t	i;
 
-	if (output_data.reg1[1] != 0)
-		OUTPUT_CHx_REG |=  OUTPUT_CHx_BIT(1);
-	else
-		OUTPUT_CHx_REG &= ~OUTPUT_CHx_BIT(1);
+	// Reset
+	if (/*dev >= oneWire.dev_count ||*/ oneWire_reset() == 0) {
+		// ungltiges Gert oder kein Presence-Pulse
+		return 0;
+	}
+
+	// Befehl senden
+	oneWire_writeByte (ONE_WIRE_CMD_MATCH_ROM);
+
+	// Adresse byteweise senden
+	for (i = 0; i < 8; i++)
+		oneWire_writeByte (oneWire.rom[dev][i]);
+
+	// alles okay
+	return 1;
 }
 
+uint8_t oneWire_readScratch (uint8_t dev)
+{
+	uint8_t	i, *data;
 
-#if ONE_WIRE_ENABLE
+	// Sensor adressieren
+	if (oneWire_selectDev (dev) == 0)
+		return 0;
+
+	// Kommando: Speicher lesen
+	oneWire_writeByte (ONE_WIRE_CMD_RD_SCRATCH);
+
+	// 9 Byte mit CRC lesen
+	data = (uint8_t *)&oneWire.data;
+	oneWire.crc8 = 0;
+
+	for (i = 0; i < sizeof(oneWire.data); i++) {
+		data[i] = oneWire_readByte ();
+		oneWire_updateCRC (data[i]);
+	}
+
+	// CRC muss 0 ergeben, die unteren 5 Bit im Konfigurationsregister sind immer 1
+	return (oneWire.crc8 == 0 && (oneWire.data.config & 0x9F) == 0x1F);
+}
+
+uint8_t oneWire_loadRom (void)
+{
+	uint8_t	dev, count, i;
+
+	// Anzahl, gelschtes EEPROM -> 0xFF
+	count = eeprom_read_byte ((const void *)(ONE_WIRE_EE_OFFSET));
+	if (count == 0 || count > ONE_WIRE_ROM_NO)
+		return 0;
+
+	// IDs lesen
+	eeprom_read_block (oneWire.rom, (const void *)(ONE_WIRE_EE_OFFSET + 1), count * 8);
+
+	for (dev = 0; dev < count; dev++) {
+		// CRC der ID prfen
+		oneWire.crc8 = 0;
+		for (i = 0; i < 8; i++)
+			oneWire_updateCRC (oneWire.rom[dev][i]);
+
+		if (oneWire.crc8 != 0)
+			return 0;
+
+		// statt Suche: Sensor direkt adressieren und den Speicher lesen
+		if (oneWire_readScratch (dev) == 0)
+			return 0;
+	}
+
+	// alle gespeicherten Sensoren sind noch da
+	oneWire.dev_count = count;
+
+	return 1;
+}
+
+void oneWire_saveRom (void)
+{
+	// nur genderte Bytes schreiben, spart Lschzyklen
+	eeprom_update_byte ((void *)(ONE_WIRE_EE_OFFSET), oneWire.dev_count);
+	eeprom_update_block (oneWire.rom, (void *)(ONE_WIRE_EE_OFFSET + 1), oneWire.dev_count * 8);
+}
+
+void oneWire_updateCRC (uint8_t byte)
+{
+	oneWire.crc8 = oneWire_crc8 (oneWire.crc8, byte);
+}
+
+uint8_t oneWire_crc8 (uint8_t crc, uint8_t byte)
+{
+	/*
+	 * Die Tabellen-Varianten rechnen in der gespiegelten Form wie im Datenblatt,
+	 * das Register ist dann gegenber der bitweisen Variante bitverdreht.
+	 * Geprft wird berall nur auf 0, das ist bei beiden Formen gleich.
+	 */
+#if CRC_1WIRE_MODE == 2
+	return pgm_read_byte (&crc_1wire_tab[crc ^ byte]);
+#elif CRC_1WIRE_MODE == 1
+	crc ^= byte;
+	return pgm_read_byte (&crc_1wire_tab_lo[crc & 0x0F]) ^ pgm_read_byte (&crc_1wire_tab_hi[crc >> 4]);
+#else
+	for (uint8_t bit = 0; bit < 8; bit++) {
+
+		// Bits vergleichen, LSB first
+		if (((crc & 0x80) != 0) != ((byte & 0x01) != 0))
+			crc = (crc << 1) ^ CRC_1WIRE_POLY;
+		else
+			crc <<= 1;
+
+		// nchstes Bit
+		byte >>= 1;
+	}
+
+	return crc;
+#endif
+}
+
+#if ONE_WIRE_ASYNC == 0
 /*
- * Lese-/Schreib-Funktionen nach MAXIM Application Note 126:
- * "1-Wire Communication Through Software"
+ * Transaktionen ohne Hintergrundbetrieb: werden sofort blockierend
+ * ausgefhrt, danach wird gleich die Rckruffunktion aufgerufen.
+ */
+uint8_t oneWire_submit (struct oneWire_job_s *job)
+{
+	uint8_t		n, byte, crc;
+
+	job->status = ONE_WIRE_JOB_BUSY;
+
+	if ((job->flags & ONE_WIRE_JOB_RESET) != 0 && oneWire_reset() == 0) {
+		// kein Gert
+		job->status = ONE_WIRE_JOB_ERR_PRESENCE;
+	} else {
+		// Bytes schreiben
+		for (n = 0; n < job->wr_count; n++)
+			oneWire_writeByte (job->wr_data[n]);
+
+		// direkt nach dem letzten Bit, sptestens 10us nach CONVERT_T
+		if ((job->flags & ONE_WIRE_JOB_SPU) != 0)
+			ONE_WIRE_SPU_ON;
+
+		// Bytes lesen
+		crc = 0;
+		for (n = 0; n < job->rd_count; n++) {
+			byte = oneWire_readByte ();
+			job->rd_data[n] = byte;
+			crc = oneWire_crc8 (crc, byte);
+		}
+
+		// CRC ber die gelesenen Bytes muss 0 ergeben
+		if ((job->flags & ONE_WIRE_JOB_CRC) != 0 && crc != 0)
+			job->status = ONE_WIRE_JOB_ERR_CRC;
+		else
+			job->status = ONE_WIRE_JOB_DONE;
+	}
+
+	if (job->done != 0)
+		job->done (job);
+
+	return 1;
+}
+
+uint8_t oneWire_busy (void)
+{
+	// alles ist sofort fertig
+	return 0;
+}
+
+void oneWire_poll (void)
+{
+	// nichts zu tun
+}
+#else
+/*
+ * Asynchrone Transaktionen
+ *
+ * Ablauf einer Transaktion: optional Reset, wr_count Bytes schreiben,
+ * rd_count Bytes lesen, optional CRC prfen. Die Transaktionen werden
+ * nacheinander aus der Warteschlange abgearbeitet, oneWire_poll () ruft
+ * im Hauptprogramm die Rckruffunktionen der beendeten Transaktionen auf.
  *
- * Suchalgorithmus nach MAXIM Application Note 187:
- * "1-Wire Search Algorithm"
+ * Bit-Banging: Die Zeitschlitze werden ber Timer1 im CTC-Mode erzeugt,
+ * 1 Tick = 1 s. Nur die kurzen Abschnitte (6 s Low-Puls, 9 s bis zum
+ * Abtasten) werden in der ISR abgewartet, alle langen Wartezeiten (Reset,
+ * 0-Bit, Recovery) laufen ber den Compare-Interrupt. Damit blockiert ein
+ * Bit die CPU hchstens ca. 20 s statt 70 s.
  *
- * Kommunikation mit DS18B20 laut Datenblatt
+ * USART: jeder Zeitschlitz ist ein UART-Zeichen, die RX-ISR wertet das
+ * Echo aus und schickt gleich das nchste Zeichen los.
  */
 
-uint8_t oneWire_reset (void)
+uint8_t oneWire_submit (struct oneWire_job_s *job)
 {
-	uint8_t		result;
-
-	ONE_WIRE_DELAY_G;
+	uint8_t		tail, sreg;
 
-	// drive DQ low
-	ONE_WIRE_OUT_LO;
-	ONE_WIRE_DELAY_H;
+	tail = oneWire_eng.tail;
 
-	// release the bus
-	ONE_WIRE_RELEASE;
-	ONE_WIRE_DELAY_I;
+	// Warteschlange voll?
+	if ((uint8_t)(tail - oneWire_eng.finished) >= ONE_WIRE_QUEUE_NO)
+		return 0;
 
-	// sample for presence pulse from slave
-	result = ONE_WIRE_READ;
+	job->status = ONE_WIRE_JOB_QUEUED;
+	oneWire_eng.queue[tail & (ONE_WIRE_QUEUE_NO - 1)] = job;
 
-	// complete the reset sequence recovery
-	ONE_WIRE_DELAY_J;
+	// die ISR darf nicht dazwischen die Abarbeitung beenden
+	sreg = SREG;
+	cli ();
 
-	// return 1 if presence pulse was 0 -> device present
-	return (result == 0);
-}
+	oneWire_eng.tail = tail + 1;
 
-void oneWire_writeBit (uint8_t data)
-{
-	if (data != 0)
-	{
-		// write '1' bit
-		// drive DQ low
-		ONE_WIRE_OUT;
-		ONE_WIRE_DELAY_A;
+	if (oneWire_eng.phase == ONE_WIRE_PH_IDLE) {
+#if ONE_WIRE_USART
+		// Empfangs-Interrupt ein, erstes Zeichen gleich losschicken
+		UCSR0B |= _BV(RXCIE0);
+		oneWire_hwStart ();
+#else
+		// Timer steht -> loslaufen lassen, erster Interrupt nach 10s
+		oneWire_eng.phase = ONE_WIRE_PH_START;
+		TCNT1 = 0;
+		OCR1A = 10 - 1;
+		TIFR1 = _BV(OCF1A);
+		TIMER1_START;
+#endif
+	}
 
-		// release the bus
-		ONE_WIRE_RELEASE;
+	SREG = sreg;
 
-		// complete the time slot and 10us recovery
-		ONE_WIRE_DELAY_B;
-	}
-	else
-	{
-		// write '0' bit
-		// drive DQ low
-		ONE_WIRE_OUT;
-		ONE_WIRE_DELAY_C;
+	return 1;
+}
 
-		// release the bus
-		ONE_WIRE_RELEASE;
-		ONE_WIRE_DELAY_D;
-	}
+uint8_t oneWire_busy (void)
+{
+	// noch nicht alle Transaktionen abgeschlossen
+	return (oneWire_eng.tail != oneWire_eng.finished);
 }
 
-void oneWire_writeByte (uint8_t data)
+void oneWire_poll (void)
 {
-	// loop to write each bit in the byte, LSB first
-	for (uint8_t i = 0; i < 8; i++) {
-		// write the LSB
-		oneWire_writeBit (data & 0x01);
+	struct oneWire_job_s	*job;
 
-		// shift the data byte for the next bit
-		data >>= 1;
+	// alle beendeten Transaktionen abschlieen
+	while (oneWire_eng.finished != oneWire_eng.head) {
+		job = oneWire_eng.queue[oneWire_eng.finished & (ONE_WIRE_QUEUE_NO - 1)];
+
+		// Platz freigeben, bevor der Rckruf neue Transaktionen einreiht
+		oneWire_eng.finished++;
+
+		if (job->done != 0)
+			job->done (job);
 	}
 }
 
-uint8_t oneWire_readBit (void)
+uint8_t oneWire_jobInit (void)
 {
-	uint8_t		result;
+	struct oneWire_job_s	*job;
 
-	// drive DQ low
-	ONE_WIRE_OUT;
-	ONE_WIRE_DELAY_A;
+	job = oneWire_eng.queue[oneWire_eng.head & (ONE_WIRE_QUEUE_NO - 1)];
 
-	// release the bus
-	ONE_WIRE_RELEASE;
-	ONE_WIRE_DELAY_E;
+	oneWire_eng.job = job;
+	oneWire_eng.index = 0;
+	oneWire_eng.mask = 1;
+	oneWire_eng.byte = 0;
+	oneWire_eng.crc8 = 0;
 
-	// sample the bit value
-	result = ONE_WIRE_READ;
-
-	// complete the time slot and 10us recovery
-	ONE_WIRE_DELAY_F;
+	job->status = ONE_WIRE_JOB_BUSY;
 
-	// return 1 if the sampled value was 1
-	return (result != 0);
+	// 1 wenn zuerst ein Reset gesendet werden muss
+	return ((job->flags & ONE_WIRE_JOB_RESET) != 0);
 }
 
-uint8_t oneWire_readByte (void)
+uint8_t oneWire_jobBit (void)
 {
-	uint8_t		result;
+	struct oneWire_job_s	*job;
+	uint8_t		index;
 
-	result = 0;
+	job = oneWire_eng.job;
+	index = oneWire_eng.index;
 
-	for (uint8_t i = 0; i < 8; i++) {
-		// shift the result to get it ready for the next bit
-		result >>= 1;
+	// Schreiben: das aktuelle Bit, LSB first
+	if (index < job->wr_count)
+		return ((job->wr_data[index] & oneWire_eng.mask) != 0);
 
-		// if sampled bit value is 1, then set MSB
-		if (oneWire_readBit())
-			result |= 0x80;
-	}
+	// Lesen: ein 1-Bit senden und abtasten
+	if ((uint8_t)(index - job->wr_count) < job->rd_count)
+		return 1;
 
-	return result;
+	// alles bertragen
+	return ONE_WIRE_JOB_END;
 }
 
-uint8_t oneWire_findFirst (void)
+void oneWire_jobSample (uint8_t bit)
 {
-	oneWire.dev_count = 0;
-	oneWire.last_device = 0;
-	oneWire.last_disc = 0;
-//	oneWire.last_fam_disc = 0;
+	struct oneWire_job_s	*job;
+	uint8_t		index, mask;
+
+	job = oneWire_eng.job;
+	index = oneWire_eng.index;
+	mask = oneWire_eng.mask;
+
+	if (index >= job->wr_count) {
+		// gelesenes Bit bernehmen
+		if (bit != 0)
+			oneWire_eng.byte |= mask;
+
+		if (mask == 0x80) {
+			// Byte komplett
+			job->rd_data[index - job->wr_count] = oneWire_eng.byte;
+			oneWire_eng.crc8 = oneWire_crc8 (oneWire_eng.crc8, oneWire_eng.byte);
+			oneWire_eng.byte = 0;
+		}
+	}
 
-	return oneWire_search ();
-}
+	// nchstes Bit
+	mask <<= 1;
+	if (mask == 0) {
+		mask = 1;
+		index++;
+	}
 
-uint8_t oneWire_findNext (void)
-{
-	return oneWire_search ();
+	oneWire_eng.index = index;
+	oneWire_eng.mask = mask;
 }
 
-uint8_t oneWire_search (void)
+uint8_t oneWire_jobEnd (uint8_t status)
 {
-	uint8_t		id_bit_no;
-	uint8_t		last_zero, rom_byte_no, result;
-	uint8_t		id_bit, id_bit_cmp;
-	uint8_t		rom_byte_mask, direction;
-
-	// initialize for search
-	id_bit_no = 1;
-	last_zero = 0;
-	rom_byte_no = 0;
-	rom_byte_mask = 1;
-	result = 0;
-	oneWire.crc8 = 0;
+	struct oneWire_job_s	*job;
 
-	// exit if ROM buffer is full
-	if (oneWire.dev_count >= ONE_WIRE_DEV_NO)
-		return 0;
+	job = oneWire_eng.job;
 
-	// if the last call was not the last one
-	if (oneWire.last_device == 0)
+	// CRC ber die gelesenen Bytes muss 0 ergeben
+	if (status == ONE_WIRE_JOB_DONE
+		&& (job->flags & ONE_WIRE_JOB_CRC) != 0
+		&& oneWire_eng.crc8 != 0)
 	{
-		// 1-Wire reset
-		if (oneWire_reset() == 0)
-		{
-			// reset the search
-			oneWire.last_disc = 0;
-			oneWire.last_device = 0;
-		//	oneWire.last_fam_disc = 0;
-
-			return 0;
-		}
-
-		// issue the search command
-		oneWire_writeByte (ONE_WIRE_CMD_SRCH_ROM);
-
-		// loop to do the search
-		do
-		{
-			// read the bit and its complement
-			id_bit = oneWire_readBit ();
-			id_bit_cmp = oneWire_readBit ();
-
-			// check for no device on 1-Wire
-			if (id_bit == 1 && id_bit_cmp == 1)
-			{
-				// no device responded
-				break;
-			}
-			else
-			{
-				// all devices coupled have 0 or 1
-				if (id_bit != id_bit_cmp)
-				{
-					// bit write value for search
-					direction = id_bit;
-				}
-				else
-				{
-					// if this discrepancy is before the last discrepancy
-					// on a previous next then pick the same as last time
-					if (id_bit_no < oneWire.last_disc)
-					{
-						direction = ((oneWire.rom[oneWire.dev_count][rom_byte_no] & rom_byte_mask) > 0);
-					}
-					else
-					{
-						// if equal to last pick 1, if not then pick 0
-						direction = (id_bit_no == oneWire.last_disc);
-					}
-
-					// if 0 was picked the revord its position
-					if (direction == 0)
-					{
-						last_zero = id_bit_no;
-
-					//	// check for last discrepancy in family
-					//	if (last_zero < 9)
-					//		oneWire.last_fam_disc = last_zero;
-					}
-				}
+		status = ONE_WIRE_JOB_ERR_CRC;
+	}
 
-				// set or clear the bit in the ROM byte rom_byte_no with mask rom_byte_mask
-				if (direction != 0)
-					oneWire.rom[oneWire.dev_count][rom_byte_no] |=  rom_byte_mask;
-				else
-					oneWire.rom[oneWire.dev_count][rom_byte_no] &= ~rom_byte_mask;
+	// starker Pull-Up nach dem letzten Bit, hlt bis ONE_WIRE_SPU_OFF
+	if (status == ONE_WIRE_JOB_DONE && (job->flags & ONE_WIRE_JOB_SPU) != 0)
+		ONE_WIRE_SPU_ON;
 
-				// serial number search direction write bit
-				oneWire_writeBit (direction);
+	// Ergebnis eintragen, ab jetzt darf oneWire_poll die Transaktion abschlieen
+	job->status = status;
+	oneWire_eng.head++;
 
-				// increment the byte counter and shift the mask
-				id_bit_no++;
-				rom_byte_mask <<= 1;
+	// 1 wenn noch eine Transaktion in der Warteschlange steht
+	return (oneWire_eng.head != oneWire_eng.tail);
+}
 
-				// if the mask is 0 the got to new ROM byte and reset mask
-				if (rom_byte_mask == 0)
-				{
-					oneWire_updateCRC (oneWire.rom[oneWire.dev_count][rom_byte_no]);
-					rom_byte_no++;
-					rom_byte_mask = 1;
-				}
-			}
-		}
-		while (rom_byte_no < 8);	// loop through all ROM bytes 0-7
+#if ONE_WIRE_USART
+void oneWire_hwStart (void)
+{
+	if (oneWire_jobInit() != 0) {
+		// Reset mit 9600 Baud: 0xF0 senden, Presence-Pulse verndert das Echo
+		UBRR0 = ONE_WIRE_UBRR_RESET;
+		oneWire_eng.phase = ONE_WIRE_PH_RESET_SMP;
+		UDR0 = 0xF0;
+	} else {
+		// gleich mit dem ersten Zeitschlitz beginnen
+		oneWire_eng.phase = ONE_WIRE_PH_SLOT;
+		oneWire_hwSlot ();
+	}
+}
 
-		// if the search was successful
-		if (!((id_bit_no < 64) || (oneWire.crc8 != 0)))
-		{
-			// search successful
-			oneWire.last_disc = last_zero;
+void oneWire_hwSlot (void)
+{
+	uint8_t		bit;
 
-			// check for last device
-			if (oneWire.last_disc == 0)
-				oneWire.last_device = 1;
+	bit = oneWire_jobBit ();
 
-			result = 1;
-		}
+	if (bit == ONE_WIRE_JOB_END) {
+		oneWire_hwEnd (ONE_WIRE_JOB_DONE);
+		return;
 	}
 
-	// if no device found then reset counters so next 'search' will be like a first
-	if (result == 0 || oneWire.rom[oneWire.dev_count][0] == 0)
-	{
-		oneWire.last_device = 0;
-		oneWire.last_disc = 0;
-	//	oneWire.last_fam_disc = 0;
-		result = 0;
+	// 0xFF: nur das Startbit ist low -> 1 schreiben oder lesen
+	// 0x00: 9 Bit low -> 0 schreiben
+	UDR0 = (bit != 0) ? 0xFF : 0x00;
+}
+
+void oneWire_hwEnd (uint8_t status)
+{
+	if (oneWire_jobEnd(status) != 0) {
+		// nchste Transaktion
+		oneWire_hwStart ();
+	} else {
+		// nichts mehr zu tun
+		UCSR0B &= ~_BV(RXCIE0);
+		oneWire_eng.phase = ONE_WIRE_PH_IDLE;
 	}
-	else
-	{
-		// next device
-		oneWire.dev_count++;
+}
+#else
+uint16_t oneWire_hwStart (void)
+{
+	if (oneWire_jobInit() != 0) {
+		// drive DQ low
+		ONE_WIRE_OUT_LO;
+		oneWire_eng.phase = ONE_WIRE_PH_RESET_REL;
+		return 480;
 	}
 
-	return result;
+	// gleich mit dem ersten Zeitschlitz beginnen
+	oneWire_eng.phase = ONE_WIRE_PH_SLOT;
+	return 10;
 }
 
-uint8_t oneWire_selectDev (uint8_t dev)
+uint16_t oneWire_hwSlot (void)
 {
-	uint8_t	i;
+	uint8_t		bit;
 
-	// Reset
-	if (/*dev >= oneWire.dev_count ||*/ oneWire_reset() == 0) {
-		// ungltiges Gert oder kein Presence-Pulse
-		return 0;
-	}
+	bit = oneWire_jobBit ();
 
-	// Befehl senden
-	oneWire_writeByte (ONE_WIRE_CMD_MATCH_ROM);
+	if (bit == ONE_WIRE_JOB_END)
+		return oneWire_hwEnd (ONE_WIRE_JOB_DONE);
 
-	// Adresse byteweise senden
-	for (i = 0; i < 8; i++)
-		oneWire_writeByte (oneWire.rom[dev][i]);
+	if (bit != 0) {
+		// write '1' bit or read
+		ONE_WIRE_OUT;
+		ONE_WIRE_DELAY_A;
+		ONE_WIRE_RELEASE;
+		ONE_WIRE_DELAY_E;
 
-	// alles okay
-	return 1;
+		// sample the bit value
+		oneWire_jobSample (ONE_WIRE_READ != 0);
+
+		// complete the time slot and 10us recovery
+		return 55;
+	}
+
+	// write '0' bit, das Loslassen bernimmt der nchste Interrupt
+	ONE_WIRE_OUT;
+	oneWire_eng.phase = ONE_WIRE_PH_WRITE0_REL;
+	oneWire_jobSample (0);
+
+	return 60;
 }
 
-void oneWire_updateCRC (uint8_t byte)
+uint16_t oneWire_hwEnd (uint8_t status)
 {
-	for (uint8_t bit = 0; bit < 8; bit++) {
+	if (oneWire_jobEnd(status) != 0) {
+		// nchste Transaktion
+		return oneWire_hwStart ();
+	}
 
-		// Bits vergleichen, LSB first
-		if (((oneWire.crc8 & 0x80) != 0) != ((byte & 0x01) != 0))
-			oneWire.crc8 = (oneWire.crc8 << 1) ^ CRC_1WIRE_POLY;
-		else
-			oneWire.crc8 <<= 1;
+	// nichts mehr zu tun
+	TIMER1_STOP;
+	oneWire_eng.phase = ONE_WIRE_PH_IDLE;
 
-		// nchstes Bit
-		byte >>= 1;
-	}
+	return 0xFFFF;
 }
+#endif	// ONE_WIRE_USART
+#endif	// ONE_WIRE_ASYNC
 
 #endif	// ONE_WIRE_ENABLE
 
@@ -2444,30 +5612,189 @@ ISR (TIMER0_COMPA_vect)
 	// speichern
 	dspl.digit = digit;
 #endif
+#if !ADC_TIMER_TRIG
+	uint8_t		src;
+#endif
+
+	// Erfassungstakt, die Ergebnisse der Quellen sind hchstens einen Teiler alt
+	if (++adc_data.trig >= ADC_ROUND) {
+		adc_data.trig = 0;
+		adc_data.complete = 1;
+	}
+
+#if !ADC_TIMER_TRIG
+	src = adc_next ();
+	if (src == ADC_SRC_NONE) {
+		// nichts fllig: ADC bis zum nchsten Trigger abschalten
+		ADCSRA = 0;
+		PRR |= _BV(PRADC);
+		return;
+	}
+
+	// die erste Wandlung nach dem Einschalten dauert 25 statt 13 Takte
+	PRR &= ~_BV(PRADC);
+	ADMUX = src | ADMUX_REFSEL;
+	ADCSRA = ADC_CSRA;
+
+#if ADC_NOISE_SLEEP
+	if (adc_data.sleep != 0) {
+		// die Hauptschleife kam seit dem letzten Trigger nicht dazu: normal wandeln
+		adc_data.sleep = 0;
+		ADCSRA |= _BV(ADSC);
+		return;
+	}
+
+	// die Wandlung startet die Hauptschleife mit dem Einschlafen, siehe adc_sleepConv
+	adc_data.sleep = 1;
+#else
+	ADCSRA |= _BV(ADSC);
+#endif
+#endif
 }
 
+#if !DSPL_MAX7219
 ISR (TIMER2_COMPA_vect)
 {
-	uint8_t	digit;
+	uint8_t	*p, i, rows;
+
+	p = dspl.ptr;
+
+	// Segmente und Ziffer (Active Low) ausgeben, die neuen Segmente stehen
+	// nur 2 Takte an der alten Ziffer an, das ist nicht zu sehen
+	PORTD = *p++;
+	PORTB = *p++;
+#if DSPL_DIM
+	// normalerweise steht TCNT2 hier noch auf 0, der Vergleich greift also schon in diesem Zeitfenster
+	OCR2B = *p;
+
+	// ein anstehendes COMPB gehrt noch zur vorigen Stelle und wrde die neue sofort lschen;
+	// kommt diese ISR zu spt (z.B. hinter der Timer0-ISR), ist TCNT2 vielleicht schon ber OCR2B
+	// hinaus, dann gibt es keinen Vergleich mehr und die Stelle bliebe voll an -> gleich lschen
+	TIFR2 = _BV(OCF2B);
+	if (TCNT2 >= *p++)
+		PORTB = 0xFF;
+#endif
 
-	digit = dspl.digit;
+	if (p == &dspl.port[0][0] + sizeof(dspl.port)) {
+		// Bild fertig, wieder von vorne
+		p = &dspl.port[0][0];
+
+		// neues Bild bernehmen, das Hauptprogramm schreibt gerade nicht
+		if (dspl.swap == DSPL_SWAP_READY) {
+			dspl.swap = DSPL_SWAP_NONE;
+			rows = dspl.blank;
+			for (i = 0; i < DIGIT_NO; i++) {
+				// zweite Zeile
+				if (i == DIGIT_NO / 2)
+					rows >>= 1;
+
+				// ausgeblendete Zeile: alle Segmente aus
+				dspl.port[i][0] = (rows & 0x01) ? 0 : dspl.seg[i];
+			}
+		}
+	}
 
-	// alles kurz aus, sonst berlappen sich die Ziffern
+	dspl.ptr = p;
+}
+
+#if DSPL_DIM
+ISR (TIMER2_COMPB_vect)
+{
+	// Einschaltdauer abgelaufen, alle Ziffern (Active Low) aus bis zur nchsten Stelle
 	PORTB = 0xFF;
+}
+#endif
+#endif	// !DSPL_MAX7219
 
-	// fertigen Wert ausgeben
-	PORTD = dspl.seg[digit];
+#if ONE_WIRE_ENABLE && ONE_WIRE_ASYNC
+#if ONE_WIRE_USART
+ISR (USART_RX_vect)
+{
+	uint8_t		rx;
 
-	// Ziffer ein (Active Low)
-	PORTB = ~(1 << digit);
+	// Echo des gesendeten Zeitschlitzes
+	rx = UDR0;
 
-	// Umlauf
-	if (++digit >= DIGIT_NO)
-		digit = 0;
+	if (oneWire_eng.phase == ONE_WIRE_PH_RESET_SMP) {
+		// zurck auf die Bitrate fr die Zeitschlitze
+		UBRR0 = ONE_WIRE_UBRR_SLOT;
 
-	// speichern
-	dspl.digit = digit;
+		if (rx == 0xF0) {
+			// unverndertes Echo -> kein Gert
+			oneWire_hwEnd (ONE_WIRE_JOB_ERR_PRESENCE);
+		} else {
+			oneWire_eng.phase = ONE_WIRE_PH_SLOT;
+			oneWire_hwSlot ();
+		}
+	} else {
+		// nur wenn kein Slave den Bus gezogen hat, kommt 0xFF zurck
+		oneWire_jobSample (rx == 0xFF);
+		oneWire_hwSlot ();
+	}
+}
+#else
+ISR (TIMER1_COMPA_vect)
+{
+	uint16_t	start, next;
+
+	// Versptung dieser ISR, z.B. durch den Display-Multiplex
+	start = TCNT1;
+
+	switch (oneWire_eng.phase)
+	{
+	case ONE_WIRE_PH_START:
+		// erste Transaktion nach dem Start des Timers
+		next = oneWire_hwStart ();
+		break;
+
+	case ONE_WIRE_PH_RESET_REL:
+		// release the bus
+		ONE_WIRE_RELEASE;
+		oneWire_eng.phase = ONE_WIRE_PH_RESET_SMP;
+		next = ONE_WIRE_TIME_PRESENCE;
+		break;
+
+	case ONE_WIRE_PH_RESET_SMP:
+		// sample for presence pulse from slave
+		if (ONE_WIRE_READ != 0) {
+			// kein Gert
+			next = oneWire_hwEnd (ONE_WIRE_JOB_ERR_PRESENCE);
+		} else {
+			// complete the reset sequence recovery
+			oneWire_eng.phase = ONE_WIRE_PH_SLOT;
+			next = 480 - ONE_WIRE_TIME_PRESENCE;
+		}
+		break;
+
+	case ONE_WIRE_PH_WRITE0_REL:
+		// release the bus, 10us recovery
+		ONE_WIRE_RELEASE;
+		oneWire_eng.phase = ONE_WIRE_PH_SLOT;
+		next = 10;
+
+		// CONVERT_T endet mit einem 0-Bit: ohne Recovery gleich zum starken Pull-Up
+		if ((oneWire_eng.job->flags & ONE_WIRE_JOB_SPU) != 0 && oneWire_jobBit () == ONE_WIRE_JOB_END)
+			next = oneWire_hwEnd (ONE_WIRE_JOB_DONE);
+		break;
+
+	default:
+		// nchster Zeitschlitz oder Ende der Transaktion
+		next = oneWire_hwSlot ();
+		break;
+	}
+
+	// Abstand zum nchsten Interrupt ab dem Beginn dieser ISR, eine Versptung
+	// verkrzt sonst den nchsten Abschnitt (Low-Puls, Presence-Abtastung)
+	next += start - 1;
+
+	// schon vorbei? Dann sofort, sonst zhlt der Timer bis 0xFFFF
+	if (next <= TCNT1)
+		next = TCNT1 + 1;
+
+	OCR1A = next;
 }
+#endif	// ONE_WIRE_USART
+#endif
 
 ISR (ADC_vect)
 {
@@ -2477,21 +5804,18 @@ ISR (ADC_vect)
 	resL = ADCL;
 	resH = ADCH;
 
-	// Quelle
-	src = adc_data.source;
-
-	// in Tabelle speichern
+	// in Tabelle speichern, gewandelt wurde der beim letzten Mal ausgewhlte Kanal
+	src = ADMUX & 0x0F;
 	adc_data.mem[src - ADMUX_MIN] = (resH << 8) | resL;
-
-	// nchste Quelle
-	if (++src > ADMUX_MAX) {
-		src = ADMUX_MIN;
-
-		// Ergebnisse verarbeiten
-		adc_data.complete = 1;
-	}
-	// und auswhlen
-	adc_data.source = src;
-	ADMUX = adc_data.source | ADMUX_REFSEL;
+	if (src == ADC_KEY_SRC)
+		adc_data.key_new = 1;
+
+#if ADC_TIMER_TRIG
+	// Quelle fr den nchsten Trigger auswhlen, gewandelt wird ohnehin, ggf. die Tasten
+	src = adc_next ();
+	if (src == ADC_SRC_NONE)
+		src = ADC_KEY_SRC;
+	ADMUX = src | ADMUX_REFSEL;
+#endif
 }
 
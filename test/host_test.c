@@ -0,0 +1,694 @@
+/*
+ * Host-Tests fr TempCtrl.c, bersetzt mit gcc auf dem PC (siehe Makefile).
+ *
+ * Die Firmware wird als Ganzes eingebunden, die AVR-Register sind in stub/
+ * einfache Variablen. Das Makefile erzeugt fr jede Variante eine Kopie der
+ * Quelle mit umgesetzten Schaltern und bergibt sie als TEMPCTRL_SRC.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define main	tempctrl_main
+#include TEMPCTRL_SRC
+#undef main
+
+
+/*---------------------------Ersatz fr avr-libc----------------------------*/
+
+static uint8_t host_ee[E2END + 1];
+
+uint8_t eeprom_read_byte (const uint8_t *addr)
+{
+	return host_ee[(uintptr_t)addr];
+}
+
+uint16_t eeprom_read_word (const uint16_t *addr)
+{
+	return host_ee[(uintptr_t)addr] | (host_ee[(uintptr_t)addr + 1] << 8);
+}
+
+void eeprom_write_byte (uint8_t *addr, uint8_t data)
+{
+	host_ee[(uintptr_t)addr] = data;
+}
+
+void eeprom_update_byte (uint8_t *addr, uint8_t data)
+{
+	host_ee[(uintptr_t)addr] = data;
+}
+
+void eeprom_read_block (void *dst, const void *src, size_t n)
+{
+	memcpy (dst, &host_ee[(uintptr_t)src], n);
+}
+
+void eeprom_write_block (const void *src, void *dst, size_t n)
+{
+	memcpy (&host_ee[(uintptr_t)dst], src, n);
+}
+
+void eeprom_update_block (const void *src, void *dst, size_t n)
+{
+	memcpy (&host_ee[(uintptr_t)dst], src, n);
+}
+
+void _delay_us (double us)
+{
+	(void)us;
+}
+
+void _delay_ms (double ms)
+{
+	(void)ms;
+}
+
+
+/*---------------------------SPI----------------------------------------------*/
+
+static struct
+{
+	uint8_t		dr;			/*!< zuletzt geschriebenes SPDR */
+	uint8_t		sr;			/*!< SPSR, SPIF wird nach jedem Byte gesetzt */
+	uint8_t		pending;	/*!< SPDR wurde beschrieben, noch nicht bertragen */
+} host_spi;
+
+/*
+ * Nachgebildeter MAX7219 am SPI: die Bytes werden in ein 16-Bit-Schieberegister
+ * geschoben, nach jedem zweiten Byte wird das Wort in die Register bernommen.
+ * Whrend des Schiebens muss LOAD low sein, Fehler werden gezhlt.
+ */
+static struct
+{
+	uint16_t	shift;		/*!< Schieberegister, Adresse im oberen Byte */
+	uint8_t		bits;		/*!< Anzahl geschobener Bytes im aktuellen Wort */
+	uint8_t		reg[16];	/*!< Register 0x00 bis 0x0F */
+	unsigned	frames;		/*!< bernommene Worte */
+	unsigned	err;		/*!< Bytes mit LOAD high */
+} host_max;
+
+volatile uint8_t *host_spdr (void)
+{
+	// Zugriff auf SPDR lscht SPIF und startet die bertragung
+	host_spi.sr &= ~_BV(SPIF);
+	host_spi.pending = 1;
+	return &host_spi.dr;
+}
+
+volatile uint8_t *host_spsr (void)
+{
+	if (host_spi.pending) {
+		host_spi.pending = 0;
+		host_spi.sr |= _BV(SPIF);
+
+		// Byte beim Slave ankommen lassen
+		if (PORTB & _BV(PB2))
+			host_max.err++;
+		host_max.shift = (host_max.shift << 8) | host_spi.dr;
+		if (++host_max.bits == 2) {
+			host_max.bits = 0;
+			host_max.reg[(host_max.shift >> 8) & 0x0F] = host_max.shift;
+			host_max.frames++;
+		}
+	}
+	return &host_spi.sr;
+}
+
+
+/*---------------------------CRC8---------------------------------------------*/
+
+// bitweise Berechnung wie vor den Tabellen, Register nicht gespiegelt
+static uint8_t ref_crc8 (uint8_t crc, uint8_t byte)
+{
+	for (uint8_t bit = 0; bit < 8; bit++) {
+		if (((crc & 0x80) != 0) != ((byte & 0x01) != 0))
+			crc = (crc << 1) ^ CRC_1WIRE_POLY;
+		else
+			crc <<= 1;
+		byte >>= 1;
+	}
+	return crc;
+}
+
+// Dallas/Maxim-CRC in der gespiegelten Form (Polynom 0x8C)
+static uint8_t ref_crc8_refl (uint8_t crc, uint8_t byte)
+{
+	crc ^= byte;
+	for (uint8_t bit = 0; bit < 8; bit++)
+		crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : crc >> 1;
+	return crc;
+}
+
+static uint8_t rev8 (uint8_t b)
+{
+	uint8_t		r = 0;
+
+	for (uint8_t i = 0; i < 8; i++, b >>= 1)
+		r = (r << 1) | (b & 0x01);
+	return r;
+}
+
+static int test_crc (void)
+{
+	// ROM-ID aus Maxim AN27, die CRC im letzten Byte ist 0xA2
+	static const uint8_t rom[8] = { 0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2 };
+	uint8_t		msg[9], crc, i;
+	int			err = 0;
+
+	// alle Registerstnde und Bytes gegen die Referenz
+	for (unsigned c = 0; c < 256; c++) {
+		for (unsigned b = 0; b < 256; b++) {
+#if CRC_1WIRE_MODE == 0
+			crc = ref_crc8 (c, b);
+#else
+			crc = rev8 (ref_crc8 (rev8 (c), b));
+#endif
+			if (oneWire_crc8 (c, b) != crc || ref_crc8_refl (rev8 (c), b) != rev8 (ref_crc8 (c, b)))
+				err++;
+		}
+	}
+
+	// bekannte Antwort: ber die ersten 7 Bytes 0xA2, ber alle 8 Bytes 0
+	crc = 0;
+	for (i = 0; i < 7; i++)
+		crc = oneWire_crc8 (crc, rom[i]);
+#if CRC_1WIRE_MODE == 0
+	crc = rev8 (crc);
+#endif
+	if (crc != 0xA2)
+		err++;
+
+	crc = 0;
+	for (i = 0; i < 8; i++)
+		crc = oneWire_crc8 (crc, rom[i]);
+	if (crc != 0)
+		err++;
+
+	// Zufallsdaten mit angehngter CRC: geprft wird in der Firmware nur auf 0
+	srand (1);
+	for (unsigned n = 0; n < 10000; n++) {
+		crc = 0;
+		for (i = 0; i < 8; i++) {
+			msg[i] = rand ();
+			crc = ref_crc8_refl (crc, msg[i]);
+		}
+		msg[8] = crc;
+
+		crc = 0;
+		for (i = 0; i < 9; i++)
+			crc = oneWire_crc8 (crc, msg[i]);
+		if (crc != 0)
+			err++;
+	}
+
+	printf ("CRC8 Variante %d: %d Fehler\n", CRC_1WIRE_MODE, err);
+	return err;
+}
+
+static void bench_crc (void)
+{
+	static uint8_t	buf[4096];
+	volatile uint8_t	sink;
+	unsigned long	bytes = 0;
+	clock_t			start, t;
+	uint8_t			crc = 0;
+
+	for (unsigned i = 0; i < sizeof(buf); i++)
+		buf[i] = rand ();
+
+	// mindestens 0,5s rechnen
+	start = clock ();
+	do {
+		for (unsigned i = 0; i < sizeof(buf); i++)
+			crc = oneWire_crc8 (crc, buf[i]);
+		bytes += sizeof(buf);
+		t = clock () - start;
+	} while (t < CLOCKS_PER_SEC / 2);
+	sink = crc;
+	(void)sink;
+
+	printf ("CRC8 Variante %d: %.1f MByte/s auf dem Host\n",
+		CRC_1WIRE_MODE, bytes / ((double)t / CLOCKS_PER_SEC) / 1e6);
+}
+
+
+/*---------------------------Dezimalanzeige-----------------------------------*/
+
+// Sollwert mit Division, Ziffern 0 bis 9 sind im Ziffernspeicher die Werte selbst
+static void ref_dec (uint8_t *mem, uint8_t first, unsigned v, uint8_t dp)
+{
+	mem[0] = first;
+	mem[1] = v / 100;
+	mem[2] = v / 10 % 10;
+	mem[3] = v % 10;
+	if (dp >= 1 && dp <= 3)
+		mem[3 - dp] |= SEGMENT_DP;
+}
+
+static int check_mem (const uint8_t *ref, uint8_t pos, const char *fn, int v, uint8_t dp)
+{
+	uint8_t		seg;
+
+	for (uint8_t i = 0; i < 4; i++) {
+		seg = pgm_read_byte (&digits[ref[i] & ~SEGMENT_DP]) | (ref[i] & SEGMENT_DP);
+		if (dspl.mem[pos + i] != ref[i] || dspl.seg[pos + i] != seg) {
+			printf ("%s (%d, %d, %d): Stelle %d ist %02X statt %02X\n",
+				fn, pos, dp, v, i, dspl.mem[pos + i], ref[i]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int test_dec (void)
+{
+	uint8_t		ref[4], mem[3], ovf[2][4], pos, dp;
+	int			err = 0, v;
+
+	// dspl_dec3 ber den ganzen Bereich
+	for (v = 0; v <= 999; v++) {
+		dspl_dec3 (mem, v);
+		if (mem[0] != v / 100 || mem[1] != v / 10 % 10 || mem[2] != v % 10) {
+			printf ("dspl_dec3 (%d): %d %d %d\n", v, mem[0], mem[1], mem[2]);
+			err++;
+		}
+	}
+
+	// Texte fr ber- und Unterlauf
+	dspl_text (0, TEXT_ID_OVF_PLUS);
+	memcpy (ovf[0], dspl.mem, 4);
+	dspl_text (0, TEXT_ID_OVF_MINUS);
+	memcpy (ovf[1], dspl.mem, 4);
+
+	for (pos = 0; pos <= 4; pos += 4) {
+		for (dp = 0; dp <= 3; dp++) {
+			// dspl_int16 ber die Anzeigegrenzen hinaus
+			for (v = -2100; v <= 2100; v++) {
+				dspl_int16 (pos, dp, v);
+				if (v > 1999)
+					memcpy (ref, ovf[0], 4);
+				else if (v < -1999)
+					memcpy (ref, ovf[1], 4);
+				else
+					ref_dec (ref, (abs (v) >= 1000 ? DIGIT_P1 : DIGIT_P0) + (v < 0), abs (v) % 1000, dp);
+				err += check_mem (ref, pos, "dspl_int16", v, dp);
+			}
+
+			// dspl_int8 mit verschobenem Komma, bei 3 Stellen luft das int16_t
+			// ber (wird in der Firmware nur mit 0 und 1 Stellen benutzt)
+			for (v = -128; v <= 127 && dp <= 2; v++) {
+				int		w = v;
+
+				for (uint8_t i = 0; i < dp; i++)
+					w *= 10;
+				dspl_int8 (pos, dp, v);
+				if (w > 1999)
+					memcpy (ref, ovf[0], 4);
+				else if (w < -1999)
+					memcpy (ref, ovf[1], 4);
+				else
+					ref_dec (ref, (abs (w) >= 1000 ? DIGIT_P1 : DIGIT_P0) + (w < 0), abs (w) % 1000, dp);
+				err += check_mem (ref, pos, "dspl_int8", v, dp);
+			}
+
+			// dspl_uint8 mit fhrender 0
+			for (v = 0; v <= 255; v++) {
+				dspl_uint8 (pos, dp, v);
+				ref_dec (ref, DIGIT_0_, v, dp);
+				err += check_mem (ref, pos, "dspl_uint8", v, dp);
+			}
+		}
+	}
+
+	printf ("Dezimalanzeige: %d Fehler\n", err);
+	return err;
+}
+
+
+/*---------------------------Parameterblock-----------------------------------*/
+
+static int check_cfg (const char *what, int8_t c1on, int8_t c1off, int8_t c2on, int8_t c2off, uint8_t res1, uint8_t res2)
+{
+	menu_loadConfig ();
+	if (temp_cfg.para[CFG_PARA_CH1_ON] != c1on || temp_cfg.para[CFG_PARA_CH1_OFF] != c1off ||
+		temp_cfg.para[CFG_PARA_CH2_ON] != c2on || temp_cfg.para[CFG_PARA_CH2_OFF] != c2off ||
+		temp_cfg.para[CFG_PARA_RES1] != res1 || temp_cfg.para[CFG_PARA_RES2] != res2 ||
+		temp_cfg.para[CFG_PARA_BRIGHT] < DSPL_CFG_BRIGHT_MIN || temp_cfg.para[CFG_PARA_BRIGHT] > DSPL_CFG_BRIGHT_MAX ||
+		TEMP_ROLE_GET(0) != TEMP_ROLE_CEILING || TEMP_ROLE_GET(1) != TEMP_ROLE_FLOOR) {
+		printf ("%s: %d %d %d %d, %d / %d Bit, Helligkeit %d, Rollen %d %d\n", what,
+			temp_cfg.para[CFG_PARA_CH1_ON], temp_cfg.para[CFG_PARA_CH1_OFF],
+			temp_cfg.para[CFG_PARA_CH2_ON], temp_cfg.para[CFG_PARA_CH2_OFF],
+			temp_cfg.para[CFG_PARA_RES1], temp_cfg.para[CFG_PARA_RES2], temp_cfg.para[CFG_PARA_BRIGHT],
+			TEMP_ROLE_GET(0), TEMP_ROLE_GET(1));
+		return 1;
+	}
+	return 0;
+}
+
+static int test_cfg (void)
+{
+	// Block einer lteren Version: 8 Byte, Platzhalter mit 0x00 beschrieben, dahinter gelscht
+	static const uint8_t	old[8] = {0, 1, 2, 30, 4, 0x00, 0x00, 0x00};
+	int		err = 0;
+
+	// gelschtes EEPROM -> Standardwerte
+	memset (host_ee, 0xFF, sizeof(host_ee));
+	err += check_cfg ("gelscht", 5, 10, 20, 10, TEMP_CFG_RES_MAX, TEMP_CFG_RES_MAX);
+
+	// alter Block -> Schwellen bernehmen, Auflsung und Rollen wie gelscht
+	memcpy (&host_ee[TEMP_CFG_EE_OFFSET], old, sizeof(old));
+	err += check_cfg ("alter Block", 1, 2, 30, 4, TEMP_CFG_RES_MAX, TEMP_CFG_RES_MAX);
+
+	// speichern und wieder laden
+	temp_cfg.para[CFG_PARA_RES1] = TEMP_CFG_RES_MIN;
+	temp_cfg.para[CFG_PARA_RES2] = TEMP_CFG_RES_MIN + 1;
+	menu_saveConfig ();
+	memset (&temp_ee_cfg, 0, sizeof(temp_ee_cfg));
+	err += check_cfg ("gespeichert", 1, 2, 30, 4, TEMP_CFG_RES_MIN, TEMP_CFG_RES_MIN + 1);
+
+	printf ("Parameterblock: %d Fehler\n", err);
+	return err;
+}
+
+
+/*---------------------------Hintergrundsuche---------------------------------*/
+
+static int check_scan (const char *what, uint8_t count, uint8_t dev, uint8_t id, uint8_t lost)
+{
+	temp_scanEnd ();
+	if (oneWire.dev_count != count || oneWire.rom[dev][1] != id || oneWire.scan_lost != lost) {
+		printf ("%s: %d Sensoren, Platz %d hat ID %02X, verschwunden %02X\n", what,
+			oneWire.dev_count, dev, oneWire.rom[dev][1], oneWire.scan_lost);
+		return 1;
+	}
+	return 0;
+}
+
+static int test_scan (void)
+{
+	uint8_t		dev;
+	int			err = 0;
+
+	// volle Tabelle, Sensor 2 ausgetauscht: der neue steht in cmd und bernimmt den Platz
+	memset (&oneWire, 0, sizeof(oneWire));
+	for (dev = 0; dev < ONE_WIRE_ROM_NO; dev++) {
+		oneWire.rom[dev][0] = ONE_WIRE_FAMILY;
+		oneWire.rom[dev][1] = dev;
+	}
+	oneWire.dev_count = ONE_WIRE_ROM_NO;
+	oneWire.scan_seen = (uint8_t)(_BV(ONE_WIRE_ROM_NO) - 1) & ~_BV(2);
+	oneWire.scan_new = 1;
+	oneWire.cmd[0] = ONE_WIRE_FAMILY;
+	oneWire.cmd[1] = 0x55;
+	err += check_scan ("Austausch", ONE_WIRE_ROM_NO, 2, 0x55, 0);
+
+	// eingerichtet wird der neue erst von temp_task, die Suche greift nicht mehr auf den Bus zu
+	if (oneWire.setup_req != _BV(2) || oneWire.state != TEMP_ST_IDLE) {
+		printf ("Austausch: Einrichten %02X, Zustand %d\n", oneWire.setup_req, oneWire.state);
+		err++;
+	}
+
+	// volle Tabelle, keiner verschwunden: der neue hat keinen Platz
+	oneWire.scan_seen = (uint8_t)(_BV(ONE_WIRE_ROM_NO) - 1);
+	oneWire.scan_new = 1;
+	oneWire.cmd[1] = 0x66;
+	err += check_scan ("voll", ONE_WIRE_ROM_NO, ONE_WIRE_ROM_NO - 1, ONE_WIRE_ROM_NO - 1, 0);
+
+	// Platz frei, ein Sensor verschwunden: der neue ersetzt ihn, der Platz dahinter bleibt leer
+	oneWire.dev_count = 3;
+	oneWire.scan_seen = _BV(0) | _BV(2);
+	oneWire.scan_new = 1;
+	oneWire.rom[3][1] = 0x77;
+	err += check_scan ("ersetzt", 3, 1, 0x77, 0);
+
+	// zwei neue: einer ersetzt den verschwundenen, der andere wird angehngt
+	oneWire.scan_seen = _BV(0) | _BV(1);
+	oneWire.rom[3][1] = 0x88;
+	oneWire.rom[4][1] = 0x99;
+	oneWire.scan_new = 2;
+	err += check_scan ("angehngt", 4, 3, 0x99, 0);
+
+	// ohne Ersatz bleibt der verschwundene gemeldet
+	oneWire.scan_seen = _BV(0) | _BV(1) | _BV(3);
+	oneWire.scan_new = 0;
+	err += check_scan ("verschwunden", 4, 2, 0x88, _BV(2));
+
+	printf ("Hintergrundsuche: %d Fehler\n", err);
+	return err;
+}
+
+
+/*---------------------------Tasten einlernen--------------------------------*/
+
+#if MENU_KEY_CAL
+static int check_key (uint8_t i, uint8_t center, uint8_t tol)
+{
+	const uint8_t	*k = &host_ee[MENU_KEY_EE_OFFSET + 1 + i * sizeof(struct menu_key_s)];
+
+	if (k[0] != center || k[1] != tol) {
+		printf ("Taste %d: Mitte %02X Toleranz %d, erwartet %02X %d\n", i, k[0], k[1], center, tol);
+		return 1;
+	}
+	return 0;
+}
+
+static int test_keys (void)
+{
+	// Zwischenablage: Mitte und halbe Streuung, MENU/UP/DOWN/OK wie in menu_key_tab
+	static const uint8_t	staged[4][3] = {{0x80, 5}, {0xAA, 3}, {0xC0, 1}, {0xCD, 6}};
+	uint8_t		n;
+	int			err = 0;
+
+	// alte gltige Tabelle
+	memset (host_ee, 0xFF, sizeof(host_ee));
+	host_ee[MENU_KEY_EE_OFFSET] = MENU_KEY_TAB_NO;
+	memset (&host_ee[MENU_KEY_EE_OFFSET + 1], 0x11, MENU_KEY_TAB_NO * sizeof(struct menu_key_s));
+
+	// erste Taste wackelt um +-2: Mitte 0x80, halbe Streuung 2
+	memset (&menu_cfg, 0, sizeof(menu_cfg));
+	menu_cfg.kcal = 1;
+	for (n = 0; n < MENU_KEY_CAL_CNT; n++)
+		menu_calKey ((n & 1) ? 0x82 : 0x7E);
+	// ein Ausreier beginnt die Zhlung neu
+	menu_calKey (0x7E + MENU_KEY_CAL_SPREAD + 1);
+	for (n = 0; n < MENU_KEY_CAL_CNT; n++)
+		menu_calKey ((n & 1) ? 0x82 : 0x7E);
+	if (menu_cfg.keyCnt != MENU_KEY_CAL_NEXT - 1)
+		err++, printf ("Einlernen: Ausreier nicht verworfen, Zhler %d\n", menu_cfg.keyCnt);
+	menu_calKey (0x80);
+	menu_calKey (0xFF);
+	if (menu_cfg.kcal != 2 || host_ee[MENU_KEY_EE_NEW] != 0x80 || host_ee[MENU_KEY_EE_NEW + 1] != 2)
+		err++, printf ("Einlernen: Platz %d, Mitte %02X, Streuung %d\n", menu_cfg.kcal,
+			host_ee[MENU_KEY_EE_NEW], host_ee[MENU_KEY_EE_NEW + 1]);
+
+	// die alte Tabelle bleibt bis menu_calEnd gltig
+	if (host_ee[MENU_KEY_EE_OFFSET] != MENU_KEY_TAB_NO || host_ee[MENU_KEY_EE_OFFSET + 1] != 0x11)
+		err++, printf ("Einlernen: alte Tabelle verndert\n");
+
+	// Toleranz: halbe Streuung + Zugabe, mindestens Standard, hchstens halber Abstand
+	for (n = 0; n < 4; n++)
+		memcpy (&host_ee[MENU_KEY_EE_NEW + n * sizeof(struct menu_key_s)], staged[n], 2);
+	menu_calEnd (4);
+	if (host_ee[MENU_KEY_EE_OFFSET] != MENU_KEY_TAB_NO)
+		err++, printf ("Einlernen: Tabelle nicht gltig\n");
+	err += check_key (0, 0x80, ADC_KEY_TOL_MENU >> 2);
+	err += check_key (1, 0xAA, 3 + MENU_KEY_CAL_MARGIN);
+	err += check_key (2, 0xC0, ADC_KEY_TOL >> 2);
+	err += check_key (3, 0xCD, (0xCD - 0xC0 - 1) / 2);
+	err += check_key (4, 0xFF, 0);
+
+	// Dekodieren direkt aus der eingelernten Tabelle, Akkordplatz frei
+	if (menu_decodeKey (0x80 + 12) != MENU_KEY_MENU || menu_decodeKey (0xCD - 6) != MENU_KEY_OK
+		|| menu_decodeKey (0xC0 + 5) != 0xFF)
+	{
+		err++, printf ("Einlernen: Dekodieren falsch\n");
+	}
+
+	printf ("Tasten einlernen: %d Fehler\n", err);
+	return err;
+}
+#endif
+
+
+/*---------------------------MAX7219------------------------------------------*/
+
+#if DSPL_MAX7219
+// Segmente A bis G auf D6 bis D0, unabhngig von der Schleife in dspl_flush
+static uint8_t ref_max (uint8_t seg)
+{
+	static const uint8_t	bit[7] = {
+		SEGMENT_A, SEGMENT_B, SEGMENT_C, SEGMENT_D, SEGMENT_E, SEGMENT_F, SEGMENT_G
+	};
+	uint8_t		out = seg & SEGMENT_DP;
+
+	for (uint8_t i = 0; i < 7; i++) {
+		if (seg & bit[i])
+			out |= 0x40 >> i;
+	}
+	return out;
+}
+
+// Ziffernregister gegen den Segmentspeicher, ausgeblendete Zeilen sind leer
+static int check_max (const char *what, uint8_t rows, unsigned frames)
+{
+	int			err = 0;
+	uint8_t		seg;
+
+	for (uint8_t i = 0; i < DIGIT_NO; i++) {
+		seg = (rows & (i < DIGIT_NO / 2 ? 0x01 : 0x02)) ? 0 : dspl.seg[i];
+		if (host_max.reg[MAX7219_DIGIT0 + i] != ref_max (seg)) {
+			printf ("MAX7219 %s: Stelle %d ist %02X statt %02X\n",
+				what, i, host_max.reg[MAX7219_DIGIT0 + i], ref_max (seg));
+			err++;
+		}
+	}
+	if (host_max.frames != frames) {
+		printf ("MAX7219 %s: %u Worte statt %u\n", what, host_max.frames, frames);
+		err++;
+	}
+	if (host_max.err != 0 || host_max.bits != 0 || (PORTB & MAX7219_LOAD) == 0) {
+		printf ("MAX7219 %s: LOAD falsch oder Wort unvollstndig\n", what);
+		err++;
+	}
+
+	host_max.frames = 0;
+	host_max.err = 0;
+	return err;
+}
+
+static int test_max (void)
+{
+	int			err = 0;
+
+	// Initialisierung: 4 Konfigurationsworte, 8 Ziffern, Shutdown aus
+	PORTB = 0xFF;
+	memset (host_max.reg, 0xAA, sizeof(host_max.reg));
+	dspl_spiInit ();
+	if (host_max.reg[MAX7219_TEST] != 0 || host_max.reg[MAX7219_DECODE] != 0 ||
+			host_max.reg[MAX7219_SCAN_LIMIT] != DIGIT_NO - 1 ||
+			host_max.reg[MAX7219_INTENSITY] != 0x0F || host_max.reg[MAX7219_SHUTDOWN] != 1) {
+		printf ("MAX7219 Init: Konfigurationsregister falsch\n");
+		err++;
+	}
+	memset (dspl.seg, 0, sizeof(dspl.seg));
+	err += check_max ("Init", 0, 4 + DIGIT_NO + 1);
+
+	// alle Stellen neu
+	dspl_int16 (0, 1, -123);
+	dspl_int16 (1, 0, 1888);
+	dspl_flush ();
+	err += check_max ("Bild", 0, DIGIT_NO);
+
+	// ohne neues Bild und mit unverndertem Bild wird nichts bertragen
+	dspl_flush ();
+	err += check_max ("ohne swap", 0, 0);
+	dspl_int16 (1, 0, 1888);
+	dspl_flush ();
+	err += check_max ("gleiches Bild", 0, 0);
+
+	// nur die genderte Stelle
+	dspl_int16 (1, 0, 1887);
+	dspl_flush ();
+	err += check_max ("eine Stelle", 0, 1);
+
+	// erste Zeile aus, dann nur die zweite
+	dspl_blank (0x01);
+	dspl_flush ();
+	err += check_max ("Zeile 1 aus", 0x01, DIGIT_NO / 2);
+	dspl_blank (0x02);
+	dspl_flush ();
+	err += check_max ("Zeile 2 aus", 0x02, DIGIT_NO);
+	dspl_blank (0);
+	dspl_flush ();
+	err += check_max ("beide an", 0, DIGIT_NO / 2);
+
+#if DSPL_DIM
+	// Helligkeit ist beim MAX7219 global
+	for (uint8_t level = 1; level <= DSPL_DIM_NO; level++) {
+		dspl_setBright (0x01, level);
+		if (host_max.reg[MAX7219_INTENSITY] != pgm_read_byte (&dspl_dim_tab[level - 1]))
+			err++;
+	}
+	err += check_max ("Helligkeit", 0, DSPL_DIM_NO);
+#endif
+
+#if DSPL_OFF_S > 0
+	dspl_off ();
+	if (host_max.reg[MAX7219_SHUTDOWN] != 0)
+		err++;
+	dspl_on ();
+	if (host_max.reg[MAX7219_SHUTDOWN] != 1)
+		err++;
+	err += check_max ("Shutdown", 0, 2);
+#endif
+
+	printf ("MAX7219: %d Fehler\n", err);
+	return err;
+}
+#endif
+
+
+/*---------------------------Menanzeige--------------------------------------*/
+
+// Rechenzeit von menu_printMenu je nderungsart, nur als Verhltnis aussagekrftig
+static double bench_printOne (uint8_t chg)
+{
+	unsigned long	n = 0;
+	clock_t			start, t;
+
+	start = clock ();
+	do {
+		for (unsigned i = 0; i < 1000; i++) {
+			menu_cfg.changed = chg;
+			menu_printMenu ();
+		}
+		n += 1000;
+		t = clock () - start;
+	} while (t < CLOCKS_PER_SEC / 4);
+
+	return (double)t / CLOCKS_PER_SEC / n * 1e9;
+}
+
+static void bench_menu (void)
+{
+	double		full, value, flash;
+
+	// bersicht mit zwei gltigen, unvernderten Messwerten
+	menu_cfg.menu = MENU_TEMP_VALUE;
+	temp_hist.chan[0] = 0;
+	temp_hist.chan[1] = 1;
+	temp_hist.value[0] = 215;
+	temp_hist.value[1] = -48;
+	temp_hist.valid = 0x03;
+
+	full = bench_printOne (MENU_CHG_FULL);
+	value = bench_printOne (MENU_CHG_VALUE);
+	flash = bench_printOne (MENU_CHG_FLASH);
+
+	printf ("menu_printMenu auf dem Host: komplett %.0f ns, Messwert unverndert %.0f ns (%.0f %%), "
+		"Blinken %.0f ns (%.0f %%)\n", full, value, value * 100 / full, flash, flash * 100 / full);
+}
+
+
+int main (void)
+{
+	int		err = 0;
+
+	err += test_crc ();
+	bench_crc ();
+	err += test_dec ();
+	bench_menu ();
+	err += test_cfg ();
+#if ONE_WIRE_SCAN_S > 0
+	err += test_scan ();
+#endif
+#if MENU_KEY_CAL
+	err += test_keys ();
+#endif
+#if DSPL_MAX7219
+	err += test_max ();
+#endif
+
+	return err != 0;
+}
@@ -0,0 +1,9 @@
+/* host stub for <avr/eeprom.h> */
+#include <stdint.h>
+#include <stddef.h>
+#define EEMEM
+uint8_t eeprom_read_byte(const uint8_t *); void eeprom_write_byte(uint8_t *, uint8_t);
+void eeprom_update_byte(uint8_t *, uint8_t);
+uint16_t eeprom_read_word(const uint16_t *);
+void eeprom_read_block(void *, const void *, size_t); void eeprom_write_block(const void *, void *, size_t);
+void eeprom_update_block(const void *, void *, size_t);
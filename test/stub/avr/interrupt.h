@@ -0,0 +1,8 @@
+/* host stub for <avr/interrupt.h> */
+#define ISR(v, ...) void v(void); void v(void)
+#define sei() ((void)0)
+#define cli() ((void)0)
+#define EMPTY_INTERRUPT(v) void v(void) {}
+#define ISR_NAKED
+#define ISR_NOBLOCK
+#define reti() ((void)0)
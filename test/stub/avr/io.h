@@ -0,0 +1,127 @@
+/*
+ * Host stub for <avr/io.h>: every register is a plain variable, the test is
+ * compiled as a single translation unit together with TempCtrl.c.
+ * SPDR and SPSR go through the simulated SPI slave in host_test.c.
+ */
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+#define _BV(b) (1 << (b))
+#define R8(n) volatile uint8_t n;
+#define R16(n) volatile uint16_t n;
+R8(PORTB) R8(DDRB) R8(PINB) R8(PORTC) R8(DDRC) R8(PINC) R8(PORTD) R8(DDRD) R8(PIND)
+R8(TCCR0A) R8(TCCR0B) R8(TCNT0) R8(OCR0A) R8(OCR0B) R8(TIMSK0) R8(TIFR0)
+R8(TCCR1A) R8(TCCR1B) R8(TCCR1C) R16(TCNT1) R16(OCR1A) R16(OCR1B) R8(TIMSK1) R8(TIFR1) R16(ICR1)
+R8(TCCR2A) R8(TCCR2B) R8(TCNT2) R8(OCR2A) R8(OCR2B) R8(TIMSK2) R8(TIFR2) R8(ASSR) R8(GTCCR)
+R8(ADMUX) R8(ADCSRA) R8(ADCSRB) R8(ADCL) R8(ADCH) R16(ADC) R8(DIDR0) R8(DIDR1)
+R8(PRR) R8(SMCR) R8(MCUCR) R8(MCUSR) R8(SREG)
+R8(UCSR0A) R8(UCSR0B) R8(UCSR0C) R16(UBRR0) R8(UBRR0H) R8(UBRR0L) R8(UDR0)
+R8(SPCR) R8(TWSR) R8(TWBR) R8(TWCR)
+R8(PCMSK0) R8(PCMSK1) R8(PCMSK2) R8(PCICR) R8(PCIFR) R8(EIMSK) R8(EICRA)
+enum { PB0,PB1,PB2,PB3,PB4,PB5,PB6,PB7 }; enum { PC0,PC1,PC2,PC3,PC4,PC5,PC6 }; enum { PD0,PD1,PD2,PD3,PD4,PD5,PD6,PD7 };
+enum { DDB0,DDB1,DDB2,DDB3,DDB4,DDB5 };
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM00 0
+#define WGM01 1
+#define WGM02 3
+#define OCIE0A 1
+#define OCIE0B 2
+#define OCF0A 1
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define OCIE1A 1
+#define OCIE1B 2
+#define TOIE1 0
+#define OCF1A 1
+#define OCF1B 2
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM20 0
+#define WGM21 1
+#define WGM22 3
+#define OCIE2A 1
+#define OCIE2B 2
+#define OCF2A 1
+#define OCF2B 2
+#define TOV2 0
+#define MUX0 0
+#define MUX1 1
+#define MUX2 2
+#define MUX3 3
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define PRADC 0
+#define PRUSART0 1
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+#define SE 0
+#define SM0 1
+#define SM1 2
+#define SM2 3
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define U2X0 1
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ01 2
+#define UCSZ00 1
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+#define SPIF 7
+#define SPI2X 0
+#define TWEN 2
+#define PUD 4
+#define PCIE1 1
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT11 3
+#define PCIF1 1
+#define E2END 255
+#define RAMEND 0x2FF
+
+volatile uint8_t *host_spdr (void);
+volatile uint8_t *host_spsr (void);
+#define SPDR	(*host_spdr())
+#define SPSR	(*host_spsr())
+
+#endif
@@ -0,0 +1,8 @@
+/* host stub for <avr/pgmspace.h> */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define memcpy_P memcpy
@@ -0,0 +1,9 @@
+/* host stub for <avr/sleep.h> */
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 2
+#define SLEEP_MODE_PWR_DOWN 4
+#define set_sleep_mode(m) ((void)(m))
+#define sleep_mode() ((void)0)
+#define sleep_enable() ((void)0)
+#define sleep_disable() ((void)0)
+#define sleep_cpu() ((void)0)
@@ -0,0 +1 @@
+/* host stub, TWI is not used on the host */
@@ -0,0 +1,4 @@
+/* host stub for <util/atomic.h> */
+#define ATOMIC_BLOCK(t) for (int _a = 1; _a; _a = 0)
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
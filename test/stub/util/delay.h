@@ -0,0 +1,2 @@
+/* host stub for <util/delay.h> */
+void _delay_us(double); void _delay_ms(double);